@@ -61,6 +61,7 @@ namespace ircd::db
 	void compact(database &, const std::pair<int, int> &level, const compactor & = {});
 	void compact(database &, const compactor & = {});
 	void sort(database &, const bool &blocking = true, const bool &now = true);
+	void ingest(database &, const vector_view<const std::pair<string_view, string_view>> &);
 	void flush(database &, const bool &sync = false);
 	void sync(database &);
 }
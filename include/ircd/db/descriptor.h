@@ -131,4 +131,8 @@ struct ircd::db::descriptor
 	{
 		8192
 	};
+
+	/// User given merge operator. When set, op::MERGE deltas to this column
+	/// are combined with the existing value by this closure.
+	db::merge_closure merger {};
 };
@@ -20,8 +20,11 @@ struct ircd::db::prefetcher
 {
 	struct ticker;
 	struct request;
+	enum prio :uint8_t;
 	using closure = std::function<bool (request &)>;
 
+	static conf::item<size_t> batch_max;
+
 	ctx::dock dock;
 	std::deque<request> queue;
 	std::unique_ptr<ticker> ticker;
@@ -29,6 +32,7 @@ struct ircd::db::prefetcher
 	size_t request_workers {0};
 
 	size_t wait_pending();
+	void request_handle(const vector_view<request *> &);
 	void request_handle(request &);
 	size_t request_cleanup() noexcept;
 	void request_worker();
@@ -46,13 +50,28 @@ struct ircd::db::prefetcher
 	~prefetcher() noexcept;
 };
 
+/// Priority class of a request. The worker serves the highest class with
+/// any pending requests first. Requests from contexts with a positive ionice
+/// (i.e. backfill) or with get::PRIO_LOW are LOW; a negative ionice or
+/// get::PRIO_HIGH is HIGH.
+enum ircd::db::prefetcher::prio
+:uint8_t
+{
+	HIGH,
+	NORMAL,
+	LOW,
+	_NUM_
+};
+
 struct ircd::db::prefetcher::request
 {
 	using key_buf = char[208];
 
 	database *d {nullptr};             // database instance
 	uint32_t cid {0};                  // column ID
-	uint32_t len {0};                  // length of key
+	uint16_t len {0};                  // length of key
+	uint8_t prio {NORMAL};             // priority class
+	uint8_t _pad_ {0};
 	steady_point snd;                  // submitted by user
 	steady_point req;                  // request sent to database
 	steady_point fin;                  // result from database
@@ -60,7 +79,7 @@ struct ircd::db::prefetcher::request
 
 	explicit operator string_view() const noexcept;
 
-	request(database &d, const column &c, const string_view &key) noexcept;
+	request(database &d, const column &c, const string_view &key, const enum prio &) noexcept;
 	request() = default;
 };
 
@@ -72,6 +91,8 @@ static_assert
 
 struct ircd::db::prefetcher::ticker
 {
+	using histogram = ircd::stats::item<ircd::stats::histogram>;
+
 	// montonic event counts
 	size_t queries {0};       ///< All incoming user requests
 	size_t rejects {0};       ///< Queries which were ignored; already cached
@@ -82,6 +103,7 @@ struct ircd::db::prefetcher::ticker
 	size_t fetches {0};       ///< Incremented before actual database operation
 	size_t fetched {0};       ///< Incremented after actual database operation
 	size_t cancels {0};       ///< Count of canceled operations
+	size_t batches {0};       ///< Count of database operations (multiple fetches)
 
 	// throughput totals
 	size_t fetched_bytes_key {0};      ///< Total bytes of key data received
@@ -94,4 +116,10 @@ struct ircd::db::prefetcher::ticker
 	// accumulated latency totals
 	microseconds accum_snd_req {0us};
 	microseconds accum_req_fin {0us};
+
+	// distributions
+	histogram batch_size;              ///< requests per batch
+	histogram latency[prio::_NUM_];    ///< snd-fin in usec by priority class
+
+	ticker();
 };
@@ -15,6 +15,7 @@ struct ircd::db::database::sst
 {
 	struct info;
 	struct dump;
+	struct build;
 
 	static void tool(const vector_view<const string_view> &args);
 };
@@ -96,3 +97,17 @@ struct ircd::db::database::sst::dump
 	dump(dump &&) = delete;
 	dump(const dump &) = delete;
 };
+
+/// Create an SST file for a column from a set of key/value pairs which can
+/// then be ingested. The pairs are sorted here by the column's comparator;
+/// keys must be unique.
+struct ircd::db::database::sst::build
+{
+	using kv = std::pair<string_view, string_view>;
+
+	sst::info info;
+
+	build(db::column, const string_view &path, const vector_view<kv> &);
+	build(build &&) = delete;
+	build(const build &) = delete;
+};
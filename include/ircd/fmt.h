@@ -28,8 +28,12 @@ namespace ircd::fmt
 	struct literal_snstringf;
 	struct literal_snstringf__max;
 	template<size_t MAX> struct bsprintf;
+	struct directive;
+	struct compiled;
+	template<char... C> struct literal;
 	using arg = std::tuple<const void *, const std::type_index &>;
 
+	template<class T, T... C> constexpr literal<C...> operator ""_fmt() noexcept;
 	literal_snstringf operator ""_snstringf(const char *text, const size_t len);
 	literal_snstringf__max operator,(const literal_snstringf, const ulong max);
 	template<class... args> std::string operator,(const literal_snstringf__max, args&&...);
@@ -37,6 +41,7 @@ namespace ircd::fmt
 
 namespace ircd
 {
+	using fmt::operator ""_fmt;
 	using fmt::operator ""_snstringf;
 }
 
@@ -67,6 +72,7 @@ class ircd::fmt::snprintf
 
 	IRCD_OVERLOAD(internal)
 	snprintf(internal_t, const mutable_buffer &, const string_view &, const va_rtti &);
+	snprintf(internal_t, const mutable_buffer &, const compiled &, const va_rtti &);
 
   public:
 	operator ssize_t() const                     { return consumed();                              }
@@ -81,6 +87,17 @@ class ircd::fmt::snprintf
 	{
 		internal, mutable_buffer{buf, max}, fmt, va_rtti{std::forward<Args>(args)...}
 	}{}
+
+	template<char... C,
+	         class... Args>
+	snprintf(char *const &buf,
+	         const size_t &max,
+	         const literal<C...> &fmt,
+	         Args&&... args)
+	:snprintf
+	{
+		internal, mutable_buffer{buf, max}, fmt.template compile<Args...>(), va_rtti{std::forward<Args>(args)...}
+	}{}
 };
 
 struct ircd::fmt::sprintf
@@ -94,6 +111,16 @@ struct ircd::fmt::sprintf
 	{
 		internal, buf, fmt, va_rtti{std::forward<Args>(args)...}
 	}{}
+
+	template<char... C,
+	         class... Args>
+	sprintf(const mutable_buffer &buf,
+	        const literal<C...> &fmt,
+	        Args&&... args)
+	:snprintf
+	{
+		internal, buf, fmt.template compile<Args...>(), va_rtti{std::forward<Args>(args)...}
+	}{}
 };
 
 /// A complement to fmt::snprintf() accepting an already-made va_rtti.
@@ -130,6 +157,14 @@ struct ircd::fmt::vsprintf
 	{
 		internal, buf, fmt, ap
 	}{}
+
+	vsprintf(const mutable_buffer &buf,
+	         const compiled &fmt,
+	         const va_rtti &ap)
+	:snprintf
+	{
+		internal, buf, fmt, ap
+	}{}
 };
 
 struct ircd::fmt::vsnstringf
@@ -182,6 +217,131 @@ struct ircd::fmt::bsprintf
 	{
 		buf, size_t(static_cast<snprintf &>(*this))
 	}{}
+
+	template<char... C,
+	         class... args>
+	bsprintf(const literal<C...> &fmt,
+	         args&&... a)
+	:snprintf
+	{
+		internal, buf, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...}
+	}
+	,string_view
+	{
+		buf, size_t(static_cast<snprintf &>(*this))
+	}{}
+};
+
+/// One specifier of a format string parsed at compile time, along with the
+/// literal text preceding it. A directive without a name carries only
+/// literal text (i.e. the tail of the format string, or an escaped '%').
+struct ircd::fmt::directive
+{
+	uint16_t pos {0};                  ///< Offset of preceding literal text
+	uint16_t len {0};                  ///< Length of preceding literal text
+	char sign {'+'};
+	char pad {' '};
+	ushort width {0};
+	ushort precision {0};
+	char name[3] {0};                  ///< Specifier name; empty for text only
+
+	static constexpr bool known(const char *name, const size_t &len);
+	static constexpr size_t scan(const char *text, const size_t &size, directive *out);
+	template<class T> static constexpr bool accepts(const char *name);
+};
+
+/// View of a format string with its directives, produced by fmt::literal
+/// after its arguments have been checked against the specifiers.
+struct ircd::fmt::compiled
+{
+	string_view format;
+	vector_view<const directive> directives;
+};
+
+/// Format string parsed at compile time; create with the _fmt literal, i.e.
+/// fmt::sprintf{buf, "%s:%u"_fmt, host, port}. Unknown specifiers are a
+/// compile error; when passed to fmt::sprintf et al or the log facilities the
+/// number and kind of arguments are checked against the specifiers, and the
+/// runtime parse of the format string is skipped entirely. Where any other
+/// string_view is expected the literal converts to one, falling back to the
+/// runtime parser.
+template<char... C>
+struct ircd::fmt::literal
+{
+	static constexpr const char text[]
+	{
+		C..., '\0'
+	};
+
+	static constexpr size_t count
+	{
+		directive::scan(text, sizeof...(C), nullptr)
+	};
+
+	static constexpr std::array<directive, count> directives
+	{
+		[]() constexpr
+		{
+			std::array<directive, count> ret {};
+			directive::scan(text, sizeof...(C), ret.data());
+			return ret;
+		}()
+	};
+
+	static constexpr size_t specifiers
+	{
+		[]() constexpr
+		{
+			size_t ret(0);
+			for(size_t i(0); i < count; ++i)
+				ret += directives[i].name[0] != '\0';
+
+			return ret;
+		}()
+	};
+
+	template<size_t I>
+	static constexpr const char *specifier()
+	{
+		for(size_t i(0), j(0); i < count; ++i)
+			if(directives[i].name[0] && j++ == I)
+				return directives[i].name;
+
+		return "";
+	}
+
+	template<class... Args, size_t... I>
+	static constexpr bool check(std::index_sequence<I...>)
+	{
+		return (directive::accepts<Args>(specifier<I>()) && ...);
+	}
+
+	template<class... Args>
+	compiled compile() const
+	{
+		static_assert
+		(
+			sizeof...(Args) == specifiers,
+			"Number of arguments does not match the format string specifiers"
+		);
+
+		static_assert
+		(
+			check<Args...>(std::index_sequence_for<Args...>{}),
+			"Argument type is not acceptable for its format string specifier"
+		);
+
+		return compiled
+		{
+			{ text, sizeof...(C) },
+			{ directives.data(), directives.size() },
+		};
+	}
+
+	constexpr operator string_view() const
+	{
+		return { text, sizeof...(C) };
+	}
 };
 
 struct ircd::fmt::literal_snstringf
@@ -228,3 +388,175 @@ ircd::fmt::operator ""_snstringf(const char *const format,
 		}
 	};
 }
+
+template<class T,
+         T... C>
+constexpr ircd::fmt::literal<C...>
+ircd::fmt::operator ""_fmt()
+noexcept
+{
+	static_assert(std::is_same<T, char>());
+	return {};
+}
+
+/// Whether an argument of type T can be printed by the named specifier.
+/// This mirrors the types handled by each specifier in the unit; only the
+/// clear mismatches are rejected here (i.e. a number given to %s) since the
+/// runtime still checks the exact type.
+template<class T>
+constexpr bool
+ircd::fmt::directive::accepts(const char *const name)
+{
+	using type = std::remove_cv_t<std::remove_reference_t<T>>;
+	switch(name[0])
+	{
+		case 's':
+			return !std::is_arithmetic<type>();
+
+		case 'c':
+			return std::is_same<type, char>();
+
+		case 'p':
+			return std::is_pointer<type>() || std::is_array<type>();
+
+		case 'f':
+			return std::is_arithmetic<type>() && !std::is_same<type, bool>();
+
+		case 'l':
+			if(name[1] == 'f')
+				return std::is_arithmetic<type>() && !std::is_same<type, bool>();
+			[[fallthrough]];
+
+		case 'b':
+		case 'd':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'z':
+			return std::is_integral<type>();
+
+		default:
+			return false;
+	}
+}
+
+/// Parses the format string with the same grammar as the runtime parser.
+/// Returns the number of directives; they are written to out if not null.
+/// Malformed specifiers end constant evaluation (a compile error).
+constexpr size_t
+ircd::fmt::directive::scan(const char *const text,
+                           const size_t &size,
+                           directive *const out)
+{
+	const auto is_alpha{[](const char &c) constexpr
+	{
+		return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+	}};
+
+	const auto is_digit{[](const char &c) constexpr
+	{
+		return c >= '0' && c <= '9';
+	}};
+
+	size_t ret(0), i(0), start(0);
+	while(i < size)
+	{
+		if(text[i] != '%')
+		{
+			++i;
+			continue;
+		}
+
+		directive d;
+		d.pos = start;
+		if(i + 1 < size && text[i + 1] == '%')
+		{
+			d.len = i + 1 - start;
+			if(out)
+				out[ret] = d;
+
+			start = i += 2;
+			++ret;
+			continue;
+		}
+
+		d.len = i - start;
+		++i;
+
+		if(i < size && (text[i] == '+' || text[i] == '-'))
+			d.sign = text[i++];
+
+		if(i < size && text[i] == '0')
+			d.pad = text[i++];
+
+		for(; i < size && is_digit(text[i]); ++i)
+			d.width = d.width * 10 + (text[i] - '0');
+
+		if(i < size && text[i] == '.')
+		{
+			if(++i >= size || !is_digit(text[i]))
+				throw invalid_format
+				{
+					"Format specifier precision requires digits"
+				};
+
+			for(; i < size && is_digit(text[i]); ++i)
+				d.precision = d.precision * 10 + (text[i] - '0');
+		}
+
+		const size_t name_pos(i);
+		for(; i < size && is_alpha(text[i]) && i - name_pos < 14; ++i);
+		if(!known(text + name_pos, i - name_pos))
+			throw invalid_format
+			{
+				"Unknown format specifier"
+			};
+
+		for(size_t j(0); j < i - name_pos; ++j)
+			d.name[j] = text[name_pos + j];
+
+		if(i < size && text[i] == '$')
+			++i;
+
+		if(out)
+			out[ret] = d;
+
+		start = i;
+		++ret;
+	}
+
+	if(start < size)
+	{
+		directive d;
+		d.pos = start;
+		d.len = size - start;
+		if(out)
+			out[ret] = d;
+
+		++ret;
+	}
+
+	return ret;
+}
+
+/// The specifiers registered by the unit. Custom specifiers registered at
+/// runtime are only available to the runtime parser.
+constexpr bool
+ircd::fmt::directive::known(const char *const name,
+                            const size_t &len)
+{
+	constexpr const char names[][3]
+	{
+		"s", "b", "c", "p", "d", "ld", "zd", "u", "lu", "zu",
+		"x", "lx", "X", "lX", "f", "lf",
+	};
+
+	for(const auto &n : names)
+	{
+		const size_t n_len(n[1]? 2: 1);
+		if(len == n_len && name[0] == n[0] && (len < 2 || name[1] == n[1]))
+			return true;
+	}
+
+	return false;
+}
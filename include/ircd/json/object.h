@@ -64,6 +64,7 @@ struct ircd::json::object
 {
 	struct member;
 	struct const_iterator;
+	struct index;
 
 	using key_type = string_view;
 	using mapped_type = string_view;
@@ -110,6 +111,7 @@ struct ircd::json::object
 
 #include "object_member.h"
 #include "object_iterator.h"
+#include "object_index.h"
 
 template<ircd::json::name_hash_t key,
          class T>
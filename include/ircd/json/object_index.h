@@ -0,0 +1,89 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_JSON_OBJECT_INDEX_H
+
+/// Opt-in index over the top-level members of a json::object.
+///
+/// The object is parsed once on construction and the offset of each key and
+/// value is recorded in a small side table along with the name_hash of the
+/// key. Lookups are then a binary search over the hashes rather than a
+/// re-parse of the object. Nothing is copied; the index refers into the
+/// object's buffer which must remain valid.
+///
+/// The table is fixed-size so an index can live on the stack. Members past
+/// MAX are not indexed; lookups which miss on an overflowed index fall back
+/// to the linear json::object behavior so results are always identical.
+/// As with json::object, the first of any duplicate keys is found.
+struct ircd::json::object::index
+{
+	static constexpr size_t MAX {32};
+
+	json::object object;
+	uint8_t count {0};
+	bool overflow {false};
+	uint8_t sorted[MAX];
+	struct entry
+	{
+		name_hash_t hash;
+		uint32_t key;                  // offset of the key from the object
+		uint32_t val;                  // offset of the value from the object
+		uint32_t val_len;
+		uint16_t key_len;
+	}
+	ent[MAX];
+
+  private:
+	const entry *find(const name_hash_t &, const string_view &key) const;
+
+  public:
+	size_t size() const;
+	const name_hash_t &hash(const size_t &pos) const;
+	member operator[](const size_t &pos) const;
+
+	bool has(const string_view &key) const;
+	string_view get(const string_view &key, const string_view &def = {}) const;
+	string_view at(const string_view &key) const;
+	string_view operator[](const string_view &key) const;
+
+	explicit index(const json::object &);
+	index(const index &) = delete;
+	index &operator=(const index &) = delete;
+};
+
+inline ircd::json::object::member
+ircd::json::object::index::operator[](const size_t &pos)
+const
+{
+	assert(pos < count);
+	const auto &e(ent[pos]);
+	const char *const base(object.data());
+	return member
+	{
+		string_view{base + e.key, e.key_len},
+		string_view{base + e.val, e.val_len},
+	};
+}
+
+inline const ircd::json::name_hash_t &
+ircd::json::object::index::hash(const size_t &pos)
+const
+{
+	assert(pos < count);
+	return ent[pos].hash;
+}
+
+inline size_t
+ircd::json::object::index::size()
+const
+{
+	return count;
+}
@@ -126,6 +126,39 @@ at(const tuple &t,
 		at<tuple, function, i + 1>(t, name, std::forward<function>(f));
 }
 
+/// Dispatch on the precomputed name_hash of the key; the key string is only
+/// compared for the member whose hash matches.
+template<class tuple,
+         class function,
+         size_t i>
+constexpr typename std::enable_if<i == size<tuple>(), void>::type
+at(tuple &t,
+   const name_hash_t &hash,
+   const string_view &name,
+   function&& f)
+noexcept
+{}
+
+template<class tuple,
+         class function,
+         size_t i = 0>
+inline typename std::enable_if<i < size<tuple>(), void>::type
+at(tuple &t,
+   const name_hash_t &hash,
+   const string_view &name,
+   function&& f)
+{
+	constexpr name_hash_t key_hash
+	{
+		name_hash(key<tuple, i>())
+	};
+
+	if(hash == key_hash && name == key<tuple, i>())
+		f(val<i>(t));
+	else
+		at<tuple, function, i + 1>(t, hash, name, std::forward<function>(f));
+}
+
 template<class R,
          class tuple>
 inline enable_if_tuple<tuple, const R &>
@@ -181,6 +181,34 @@ catch(const std::exception &e)
 	};
 }
 
+template<class V,
+         class... T>
+inline tuple<T...> &
+set(tuple<T...> &t,
+    const name_hash_t &hash,
+    const string_view &key,
+    V&& val)
+try
+{
+	at(t, hash, key, [&key, &val]
+	(auto &target)
+	{
+		_assign(target, std::forward<V>(val));
+	});
+
+	return t;
+}
+catch(const std::exception &e)
+{
+	throw parse_error
+	{
+		"failed to set member '%s' (from %s): %s",
+		key,
+		demangle<V>(),
+		e.what()
+	};
+}
+
 template<class... T>
 inline tuple<T...> &
 set(tuple<T...> &t,
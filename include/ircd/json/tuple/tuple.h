@@ -80,6 +80,7 @@ struct tuple
 	template<class... U> explicit tuple(const tuple<U...> &);
 	template<class U> explicit tuple(const json::object &, const json::keys<U> &);
 	template<class U> explicit tuple(const tuple &, const json::keys<U> &);
+	explicit tuple(const json::object::index &);
 	tuple(const json::object &);
 	tuple(const json::iov &);
 	tuple(const json::members &);
@@ -209,7 +210,34 @@ tuple<T...>::tuple(const json::object &object)
 }
 {
 	for(const auto &[key, val] : object)
-		set(*this, key, val);
+		set(*this, name_hash(key), key, val);
+}
+
+template<class... T>
+inline
+tuple<T...>::tuple(const json::object::index &index)
+:source
+{
+	index.object
+}
+{
+	if(unlikely(index.overflow))
+	{
+		for(const auto &[key, val] : index.object)
+			set(*this, name_hash(key), key, val);
+
+		return;
+	}
+
+	for(size_t i(0); i < index.size(); ++i)
+	{
+		const auto &[key, val]
+		{
+			index[i]
+		};
+
+		set(*this, index.hash(i), key, val);
+	}
 }
 
 template<class... T>
@@ -16,6 +16,12 @@
 #undef ERROR
 #endif
 
+namespace ircd::fmt
+{
+	struct compiled;
+	template<char...> struct literal;
+}
+
 /// Logging system
 namespace ircd::log
 {
@@ -125,6 +131,7 @@ struct ircd::log::hook
 struct ircd::log::vlog
 {
 	vlog(const log &log, const level &, const string_view &fmt, const va_rtti &ap);
+	vlog(const log &log, const level &, const fmt::compiled &fmt, const va_rtti &ap);
 };
 
 /// Lower level interface; allows log facility and level to be specified at
@@ -136,6 +143,12 @@ struct ircd::log::logf
 	{
 		vlog(log, level, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	logf(const log &log, const level &level, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 
 /// Manually insert a special message to the log which can be used later
@@ -171,6 +184,18 @@ struct ircd::log::debug
 	{
 		vlog(general, level::DEBUG, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	debug(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level::DEBUG, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
+
+	template<char... C, class... args>
+	debug(const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(general, level::DEBUG, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 #elif defined(__clang__)
 struct ircd::log::debug
@@ -184,6 +209,16 @@ struct ircd::log::debug
 	debug(const string_view &fmt, args&&... a)
 	{
 	}
+
+	template<char... C, class... args>
+	debug(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+
+	template<char... C, class... args>
+	debug(const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
 };
 #else
 struct ircd::log::debug
@@ -214,6 +249,18 @@ struct ircd::log::dwarning
 	{
 		vlog(general, level::DWARNING, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	dwarning(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level::DWARNING, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
+
+	template<char... C, class... args>
+	dwarning(const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(general, level::DWARNING, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 #elif defined(__clang__)
 struct ircd::log::dwarning
@@ -227,6 +274,16 @@ struct ircd::log::dwarning
 	dwarning(const string_view &fmt, args&&... a)
 	{
 	}
+
+	template<char... C, class... args>
+	dwarning(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+
+	template<char... C, class... args>
+	dwarning(const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
 };
 #else
 struct ircd::log::dwarning
@@ -257,6 +314,18 @@ struct ircd::log::derror
 	{
 		vlog(general, level::DERROR, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	derror(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level::DERROR, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
+
+	template<char... C, class... args>
+	derror(const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(general, level::DERROR, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 #elif defined(__clang__)
 struct ircd::log::derror
@@ -270,6 +339,16 @@ struct ircd::log::derror
 	derror(const string_view &fmt, args&&... a)
 	{
 	}
+
+	template<char... C, class... args>
+	derror(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+
+	template<char... C, class... args>
+	derror(const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
 };
 #else
 struct ircd::log::derror
@@ -300,6 +379,18 @@ struct ircd::log::info
 	{
 		vlog(general, level::INFO, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	info(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level::INFO, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
+
+	template<char... C, class... args>
+	info(const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(general, level::INFO, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 #elif defined(__clang__)
 struct ircd::log::info
@@ -313,6 +404,16 @@ struct ircd::log::info
 	info(const string_view &fmt, args&&... a)
 	{
 	}
+
+	template<char... C, class... args>
+	info(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+
+	template<char... C, class... args>
+	info(const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
 };
 #else
 struct ircd::log::info
@@ -343,8 +444,22 @@ struct ircd::log::notice
 	{
 		vlog(general, level::NOTICE, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	notice(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level::NOTICE, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
+
+	template<char... C, class... args>
+	notice(const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(general, level::NOTICE, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 #elif defined(__clang__)
+struct ircd::log::notice
+{
 	template<class... args>
 	notice(const log &log, const string_view &fmt, args&&... a)
 	{
@@ -354,6 +469,17 @@ struct ircd::log::notice
 	notice(const string_view &fmt, args&&... a)
 	{
 	}
+
+	template<char... C, class... args>
+	notice(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+
+	template<char... C, class... args>
+	notice(const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+};
 #else
 struct ircd::log::notice
 {
@@ -383,6 +509,18 @@ struct ircd::log::warning
 	{
 		vlog(general, level::WARNING, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	warning(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level::WARNING, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
+
+	template<char... C, class... args>
+	warning(const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(general, level::WARNING, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 #elif defined(__clang__)
 struct ircd::log::warning
@@ -396,6 +534,16 @@ struct ircd::log::warning
 	warning(const string_view &fmt, args&&... a)
 	{
 	}
+
+	template<char... C, class... args>
+	warning(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+
+	template<char... C, class... args>
+	warning(const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
 };
 #else
 struct ircd::log::warning
@@ -426,6 +574,18 @@ struct ircd::log::error
 	{
 		vlog(general, level::ERROR, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	error(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level::ERROR, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
+
+	template<char... C, class... args>
+	error(const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(general, level::ERROR, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 #elif defined(__clang__)
 struct ircd::log::error
@@ -439,6 +599,16 @@ struct ircd::log::error
 	error(const string_view &fmt, args&&... a)
 	{
 	}
+
+	template<char... C, class... args>
+	error(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+
+	template<char... C, class... args>
+	error(const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
 };
 #else
 struct ircd::log::error
@@ -494,6 +664,18 @@ struct ircd::log::critical
 	{
 		vlog(general, level::CRITICAL, fmt, va_rtti{std::forward<args>(a)...});
 	}
+
+	template<char... C, class... args>
+	critical(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(log, level::CRITICAL, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
+
+	template<char... C, class... args>
+	critical(const fmt::literal<C...> &fmt, args&&... a)
+	{
+		vlog(general, level::CRITICAL, fmt.template compile<args...>(), va_rtti{std::forward<args>(a)...});
+	}
 };
 #elif defined(__clang__)
 struct ircd::log::critical
@@ -507,6 +689,16 @@ struct ircd::log::critical
 	critical(const string_view &fmt, args&&... a)
 	{
 	}
+
+	template<char... C, class... args>
+	critical(const log &log, const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
+
+	template<char... C, class... args>
+	critical(const fmt::literal<C...> &fmt, args&&... a)
+	{
+	}
 };
 #else
 struct ircd::log::critical
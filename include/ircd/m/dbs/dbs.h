@@ -51,12 +51,16 @@ namespace ircd::m::dbs::appendix
 #include "event_sender.h"           // sender | event_idx || hostpart | localpart, event_idx
 #include "event_type.h"             // type | event_idx
 #include "event_state.h"            // state_key, type, room_id, depth, event_idx
+#include "event_auth_chain.h"       // event_idx => [auth_event_idx...]
 #include "room_events.h"            // room_id | depth, event_idx
 #include "room_type.h"              // room_id | type, depth, event_idx
 #include "room_state.h"             // room_id | type, state_key => event_idx
 #include "room_state_space.h"       // room_id | type, state_key, depth, event_idx
 #include "room_joined.h"            // room_id | origin, member => event_idx
 #include "room_head.h"              // room_id | event_id => event_idx
+#include "room_search.h"            // room_id | term => event_idx postings
+#include "room_state_delta.h"       // room_id | depth, event_idx => type, state_key
+#include "room_state_snapshot.h"    // room_id | depth => state cells
 
 /// Options that affect the dbs::write() of an event to the transaction.
 struct ircd::m::dbs::write_opts
@@ -186,6 +190,17 @@ enum ircd::m::dbs::appendix::index
 
 	/// Take branch to handle room redaction events.
 	ROOM_REDACT,
+
+	/// Involves room_search table (full text index of content).
+	ROOM_SEARCH,
+
+	/// Involves the event_auth_chain column (auth_events links of events
+	/// which can be auth_events). NOTE: QUERY
+	EVENT_AUTH_CHAIN,
+
+	/// Involves room_state_delta table (state events by depth) and removes
+	/// the room_state_snapshot entries above the event. NOTE: QUERY
+	ROOM_STATE_DELTA,
 };
 
 struct ircd::m::dbs::init
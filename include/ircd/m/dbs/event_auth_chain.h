@@ -0,0 +1,40 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_EVENT_AUTH_CHAIN_H
+
+namespace ircd::m::dbs
+{
+	using event_auth_chain_closure = std::function<void (const vector_view<const event::idx> &)>;
+
+	// Whether the event's auth_events are indexed; only for types which can
+	// be selected as auth_events.
+	bool event_auth_chain_type(const string_view &type);
+
+	// Closure receives the sorted auth_events; false if not indexed.
+	bool find_event_auth_chain(const event::idx &, const event_auth_chain_closure &);
+
+	void _index_event_auth_chain(db::txn &, const event &, const write_opts &);
+
+	// event_idx => [auth_event_idx...]
+	extern db::column event_auth_chain;
+}
+
+namespace ircd::m::dbs::desc
+{
+	extern conf::item<std::string> event_auth_chain__comp;
+	extern conf::item<size_t> event_auth_chain__block__size;
+	extern conf::item<size_t> event_auth_chain__meta_block__size;
+	extern conf::item<size_t> event_auth_chain__cache__size;
+	extern conf::item<size_t> event_auth_chain__cache_comp__size;
+	extern conf::item<size_t> event_auth_chain__bloom__bits;
+	extern const db::descriptor event_auth_chain;
+}
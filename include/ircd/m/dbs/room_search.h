@@ -0,0 +1,64 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_ROOM_SEARCH_H
+
+namespace ircd::m::dbs
+{
+	constexpr size_t ROOM_SEARCH_TERM_MAX_SIZE
+	{
+		48
+	};
+
+	constexpr size_t ROOM_SEARCH_KEY_MAX_SIZE
+	{
+		id::MAX_SIZE                   // room_id
+		+ 1                            // \0
+		+ ROOM_SEARCH_TERM_MAX_SIZE    // term
+	};
+
+	using room_search_term_closure = std::function<bool (const string_view &)>;
+	using room_search_postings_closure = std::function<bool (const event::idx &)>;
+
+	// Normalized terms of some text in order; may repeat.
+	bool room_search_terms(const string_view &text, const room_search_term_closure &);
+
+	// Delta-encoded postings; encoder input must be sorted and unique.
+	bool room_search_postings(const string_view &val, const room_search_postings_closure &);
+	string_view room_search_postings(const mutable_buffer &out, const vector_view<const event::idx> &);
+
+	string_view
+	room_search_key(const string_view &amalgam);
+
+	string_view
+	room_search_key(const mutable_buffer &out,
+	                const id::room &,
+	                const string_view &term = {});
+
+	void _index_room_search(db::txn &, const event &, const write_opts &);
+
+	// room_id | term => event_idx postings
+	extern db::domain room_search;
+}
+
+namespace ircd::m::dbs::desc
+{
+	// room events full text
+	extern conf::item<size_t> room_search__terms__max;
+	extern conf::item<std::string> room_search__comp;
+	extern conf::item<size_t> room_search__block__size;
+	extern conf::item<size_t> room_search__meta_block__size;
+	extern conf::item<size_t> room_search__cache__size;
+	extern conf::item<size_t> room_search__cache_comp__size;
+	extern conf::item<size_t> room_search__bloom__bits;
+	extern const db::prefix_transform room_search__pfx;
+	extern const db::descriptor room_search;
+}
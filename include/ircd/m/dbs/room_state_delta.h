@@ -0,0 +1,48 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_ROOM_STATE_DELTA_H
+
+namespace ircd::m::dbs
+{
+	constexpr size_t ROOM_STATE_DELTA_KEY_MAX_SIZE
+	{
+		id::MAX_SIZE + 1 + 8 + 8
+	};
+
+	constexpr size_t ROOM_STATE_DELTA_VAL_MAX_SIZE
+	{
+		event::TYPE_MAX_SIZE + 1 + event::STATE_KEY_MAX_SIZE
+	};
+
+	string_view room_state_delta_key(const mutable_buffer &out, const id::room &, const int64_t &depth, const event::idx & = 0);
+	std::tuple<int64_t, event::idx> room_state_delta_key(const string_view &amalgam);
+
+	string_view room_state_delta_val(const mutable_buffer &out, const string_view &type, const string_view &state_key);
+	std::tuple<string_view, string_view> room_state_delta_val(const string_view &val);
+
+	void _index_room_state_delta(db::txn &, const event &, const write_opts &);
+
+	// room_id | depth, event_idx => type, state_key
+	extern db::domain room_state_delta;
+}
+
+namespace ircd::m::dbs::desc
+{
+	extern conf::item<std::string> room_state_delta__comp;
+	extern conf::item<size_t> room_state_delta__block__size;
+	extern conf::item<size_t> room_state_delta__meta_block__size;
+	extern conf::item<size_t> room_state_delta__cache__size;
+	extern conf::item<size_t> room_state_delta__cache_comp__size;
+	extern conf::item<size_t> room_state_delta__bloom__bits;
+	extern const db::prefix_transform room_state_delta__pfx;
+	extern const db::descriptor room_state_delta;
+}
@@ -0,0 +1,55 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_DBS_ROOM_STATE_SNAPSHOT_H
+
+namespace ircd::m::dbs
+{
+	using room_state_snapshot_cell = std::tuple<string_view, string_view, int64_t, event::idx>;
+	using room_state_snapshot_closure = std::function<bool (const string_view &, const string_view &, const int64_t &, const event::idx &)>;
+
+	constexpr size_t ROOM_STATE_SNAPSHOT_KEY_MAX_SIZE
+	{
+		id::MAX_SIZE + 1 + 8
+	};
+
+	string_view room_state_snapshot_key(const mutable_buffer &out, const id::room &, const int64_t &depth);
+	int64_t room_state_snapshot_key(const string_view &amalgam);
+
+	// Depth of the keyframe the snapshot is a difference from, or -1 when the
+	// snapshot is itself a keyframe.
+	int64_t room_state_snapshot_base(const string_view &val);
+
+	// Cells of the snapshot in (type, state_key) order; the views are only
+	// valid for the duration of the closure.
+	bool room_state_snapshot_cells(const string_view &val, const room_state_snapshot_closure &);
+
+	// Encoder input must be sorted by (type, state_key) and unique.
+	std::string room_state_snapshot_cells(const int64_t &base, const vector_view<const room_state_snapshot_cell> &);
+
+	// Appends deletions of snapshots of the room above the depth.
+	size_t room_state_snapshot_invalidate(db::txn &, const id::room &, const int64_t &depth);
+
+	// room_id | depth => (type, state_key, depth, event_idx)...
+	extern db::domain room_state_snapshot;
+}
+
+namespace ircd::m::dbs::desc
+{
+	extern conf::item<std::string> room_state_snapshot__comp;
+	extern conf::item<size_t> room_state_snapshot__block__size;
+	extern conf::item<size_t> room_state_snapshot__meta_block__size;
+	extern conf::item<size_t> room_state_snapshot__cache__size;
+	extern conf::item<size_t> room_state_snapshot__cache_comp__size;
+	extern conf::item<size_t> room_state_snapshot__bloom__bits;
+	extern const db::prefix_transform room_state_snapshot__pfx;
+	extern const db::descriptor room_state_snapshot;
+}
@@ -0,0 +1,67 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_EPHEMERAL_H
+
+namespace ircd::m
+{
+	struct ephemeral;
+}
+
+/// Coalescing store for ephemeral state which is kept in the user's room
+/// (i.e. presence and read receipts). An update is written through when its
+/// key hasn't been written within the rate interval; otherwise it is held
+/// here and only the latest held update is written when the interval
+/// expires, and not at all if it's the same as what was last written. This
+/// way a flapping client costs at most one event per interval.
+///
+/// Readers should query here before the user's room; the latest update is
+/// found here until the interval after its write expires. Held updates are
+/// written out when the server quits.
+struct ircd::m::ephemeral
+{
+	struct entry;
+	using closure = std::function<void (const json::object &)>;
+	using write_closure = std::function<event::id::buf (const string_view &key, const json::object &)>;
+
+	string_view name;
+	const conf::item<milliseconds> &rate;
+	write_closure writer;
+	std::map<std::string, entry, std::less<>> map;
+	size_t pending {0};
+	size_t writes {0};
+	size_t coalesced {0};
+	ctx::dock dock;
+	ctx::context context;
+	run::changed quit;
+
+  private:
+	void write(const std::string &key, entry &);
+	system_point flush();
+	void worker();
+
+  public:
+	bool get(const string_view &key, const closure &) const;
+	event::id::buf set(const string_view &key, const json::object &);
+
+	ephemeral(const string_view &name, const conf::item<milliseconds> &rate, write_closure);
+	ephemeral(ephemeral &&) = delete;
+	ephemeral(const ephemeral &) = delete;
+	~ephemeral() noexcept;
+};
+
+struct ircd::m::ephemeral::entry
+{
+	std::string content;               // latest update
+	std::string written;               // last update written
+	system_point last;                 // time of last write
+	bool pending {false};              // content not yet written
+};
@@ -19,6 +19,8 @@ namespace ircd::m::fed
 struct ircd::m::fed::send_join
 :request
 {
+	struct opts;
+
 	explicit operator json::array() const
 	{
 		return json::array
@@ -35,3 +37,12 @@ struct ircd::m::fed::send_join
 
 	send_join() = default;
 };
+
+struct ircd::m::fed::send_join::opts
+:request::opts
+{
+	/// Request the v2 endpoint with omit_members; the remote may then leave
+	/// the membership events out of the state. The response is an object
+	/// rather than the v1 [code, object] array either way.
+	bool omit_members {false};
+};
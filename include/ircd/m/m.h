@@ -81,6 +81,7 @@ namespace ircd
 #include "fed/fed.h"
 #include "keys.h"
 #include "edu.h"
+#include "ephemeral.h"
 #include "presence.h"
 #include "typing.h"
 #include "receipt.h"
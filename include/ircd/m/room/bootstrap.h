@@ -14,6 +14,7 @@
 struct ircd::m::room::bootstrap
 {
 	static bool required(const id &);
+	static bool complete(const id &);
 
 	// restrap: synchronous; send_join
 	bootstrap(const event &, const string_view &host, const string_view &room_version = {});
@@ -125,6 +125,7 @@ struct ircd::m::room
 	struct message;
 	struct bootstrap;
 	struct content;
+	struct visibility;
 
 	using id = m::id::room;
 	using alias = m::id::room_alias;
@@ -204,6 +205,7 @@ struct ircd::m::room
 #include "server_acl.h"
 #include "message.h"
 #include "bootstrap.h"
+#include "visibility.h"
 
 inline
 ircd::m::room::room(const id &room_id,
@@ -41,6 +41,9 @@ struct ircd::m::room::state
 	// Check if this object is representing the present state or a past state.
 	bool present() const;
 
+	// Check if the state of the room is still being obtained after a join.
+	bool partial() const;
+
 	// Iterate the state
 	bool for_each(const string_view &type, const string_view &lower_bound, const closure_bool &view) const;
 	bool for_each(const string_view &type, const string_view &lower_bound, const event::closure_idx_bool &view) const;
@@ -96,6 +99,8 @@ struct ircd::m::room::state
 	static event::idx next(const event::idx &);
 
 	static bool present(const event::idx &);
+	static bool partial(const room::id &);
+	static bool partial_servers(const room::id &, const std::function<bool (const string_view &)> &);
 	static size_t purge_replaced(const room::id &);
 	static bool is(std::nothrow_t, const event::idx &);
 	static bool is(const event::idx &);
@@ -17,8 +17,13 @@
 ///
 struct ircd::m::room::state::history
 {
+	struct snapshot;
 	using closure = std::function<bool (const string_view &, const string_view &, const int64_t &, const event::idx &)>;
 
+	static conf::item<bool> snapshot_enable;
+	static conf::item<size_t> snapshot_interval;
+	static conf::item<size_t> snapshot_diff_max;
+
 	state::space space;
 	int64_t bound {-1};
 
@@ -43,3 +48,38 @@ struct ircd::m::room::state::history
 	history(const m::room::id &, const m::event::id &);
 	history(const m::room &);
 };
+
+/// The state below a depth reconstructed from the nearest stored snapshot at
+/// or below it and the deltas between; see dbs::room_state_snapshot. This is
+/// not complete when the room has no snapshot and its deltas don't reach back
+/// to the create event (i.e. the room predates them); the state space must
+/// be used instead.
+///
+struct ircd::m::room::state::history::snapshot
+{
+	struct cell
+	{
+		int64_t depth {-1};
+		event::idx event_idx {0};
+		bool changed {false};           // differs from the keyframe
+	};
+
+	room::id room_id;
+	int64_t bound {-1};
+	int64_t base {-1};                  // depth of the snapshot applied
+	int64_t keyframe {-1};              // depth of its keyframe
+	uint64_t retired {0};               // vm::sequence prior to reading
+	size_t deltas {0};                  // deltas applied above the base
+	bool complete {false};
+	std::map<std::string, cell, std::less<>> cells;
+
+  private:
+	bool apply(const string_view &val, const bool &changed);
+	bool valid() const;
+
+  public:
+	bool for_each(const closure &) const;
+	bool save() const;
+
+	snapshot(const room::id &, const int64_t &bound);
+};
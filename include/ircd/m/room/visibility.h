@@ -0,0 +1,36 @@
+// Matrix Construct
+//
+// Copyright (C) Matrix Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+#pragma once
+#define HAVE_IRCD_M_ROOM_VISIBILITY_H
+
+/// The depths of a room at which a user may see events. This is computed
+/// from the transitions of the user's membership and the history_visibility
+/// found in the state-space; an event is then tested with a binary search of
+/// its depth rather than by querying the state at the event. The state at
+/// an event is the state before its depth, as in room::state::history; a
+/// transition at depth d takes effect from depth d+1.
+///
+/// m::visible() keeps these in a cache which is invalidated when a member
+/// or history_visibility event is evaluated for the room.
+///
+struct ircd::m::room::visibility
+{
+	using interval = std::pair<int64_t, int64_t>;
+
+	/// Sorted and disjoint; each is the half-open range [first, second).
+	std::vector<interval> allow;
+
+  public:
+	bool operator()(const int64_t &depth) const;
+
+	visibility(const m::room &, const id::user &);
+	visibility() = default;
+};
@@ -94,6 +94,8 @@ struct ircd::m::vm::eval
 	hook::base *hook {nullptr};
 	vm::phase phase {vm::phase(0)};
 	bool room_internal {false};
+	const event::conforms *conformed {nullptr};
+	bool verified {false};
 
 	void mfetch_keys() const;
 
@@ -274,6 +276,11 @@ struct ircd::m::vm::opts
 	/// perform a parallel/mass fetch before proceeding with the evals.
 	bool mfetch_keys {true};
 
+	/// Whether to check the hashes and signatures of an input vector of events
+	/// in parallel on the offload threads before proceeding with the evals.
+	/// The verdicts are then used by the CONFORM and VERIFY phases.
+	bool mverify {true};
+
 	/// Throws fault::EVENT if *all* of the prev_events do not exist locally.
 	/// This is used to enforce that at least one path is traversable. This
 	/// test is conducted after waiting if fetch_prev and fetch_prev_wait.
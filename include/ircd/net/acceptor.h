@@ -35,6 +35,8 @@ struct ircd::net::acceptor
 	static conf::item<std::string> ssl_curve_list;
 	static conf::item<std::string> ssl_cipher_list;
 	static conf::item<std::string> ssl_cipher_blacklist;
+	static conf::item<size_t> handshake_threads;
+	static stats::item<stats::histogram> handshake_latency;
 
 	net::listener *listener_;
 	std::string name;
@@ -64,7 +66,8 @@ struct ircd::net::acceptor
 	bool handle_sni(socket &, int &ad);
 	string_view handle_alpn(socket &, const vector_view<const string_view> &in);
 	void check_handshake_error(const error_code &ec, socket &) const;
-	void handshake(const error_code &, const std::shared_ptr<socket>, const decltype(handshaking)::const_iterator) noexcept;
+	void handshake(const error_code &, const std::shared_ptr<socket>, const decltype(handshaking)::const_iterator, const steady_point &started) noexcept;
+	void handshake_offload(const std::shared_ptr<socket> &, const decltype(handshaking)::const_iterator, const steady_point &started);
 
 	// Acceptance stack
 	static bool proffer_default(listener &, const ipport &);
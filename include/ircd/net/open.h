@@ -113,6 +113,12 @@ struct ircd::net::open_opts
 
 	/// Option to allow expired certificates.
 	bool allow_expired { default_allow_expired };
+
+	/// TLS session to resume, serialized; usually shared by all connections
+	/// to the same remote. When set, the handshake offers the session if it
+	/// isn't empty, and any new session (or ticket) the remote issues over
+	/// the connection replaces the contents.
+	std::shared_ptr<std::string> session;
 };
 
 /// Constructor intended to provide implicit conversions (no-brackets required)
@@ -52,6 +52,8 @@ struct ircd::net::socket
 	static stats::item<uint64_t> total_bytes_out;
 	static stats::item<uint64_t> total_calls_in;
 	static stats::item<uint64_t> total_calls_out;
+	static stats::item<uint64_t> handshake_full;
+	static stats::item<uint64_t> handshake_resumed;
 	static ios::descriptor desc_connect;
 	static ios::descriptor desc_handshake;
 	static ios::descriptor desc_disconnect;
@@ -61,6 +63,7 @@ struct ircd::net::socket
 	uint64_t id {++count};
 	ip::tcp::socket sd;
 	asio::ssl::stream<ip::tcp::socket &> ssl;
+	std::shared_ptr<std::string> session;
 	stat in, out;
 	deadline_timer timer;
 	uint64_t timer_sem[2] {0};                   // handler, sender
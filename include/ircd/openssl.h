@@ -17,6 +17,7 @@
 struct ssl_st;
 struct ssl_ctx_st;
 struct ssl_cipher_st;
+struct ssl_session_st;
 struct rsa_st;
 struct x509_st;
 struct x509_store_ctx_st;
@@ -43,6 +44,7 @@ namespace ircd::openssl
 	using SSL = ::ssl_st;
 	using SSL_CTX = ::ssl_ctx_st;
 	using SSL_CIPHER = ::ssl_cipher_st;
+	using SSL_SESSION = ::ssl_session_st;
 	using RSA = ::rsa_st;
 	using X509 = ::x509_st;
 	using X509_STORE_CTX = ::x509_store_ctx_st;
@@ -142,6 +144,13 @@ namespace ircd::openssl
 	string_view server_name(const SSL &); // provided by client
 	void server_name(SSL &, const string_view &); // set by client
 
+	// Session suite
+	using new_session_cb = int (*)(SSL *, SSL_SESSION *);
+	bool session_reused(const SSL &);
+	string_view get_session(const mutable_buffer &, const SSL_SESSION &);
+	bool set_session(SSL &, const const_buffer &);
+	void set_session_cache(SSL_CTX &, new_session_cb);
+
 	// Header version; library version
 	extern const info::versions version_api, version_abi;
 	extern const info::versions libressl_version_api;
@@ -70,9 +70,14 @@ struct ircd::resource::method::opts
 
 struct ircd::resource::method::stats
 {
+	using histogram = ircd::stats::item<ircd::stats::histogram>;
+
 	uint64_t pending {0};             // Clients currently inside the method
 	uint64_t requests {0};            // The method was found and called.
 	uint64_t timeouts {0};            // The method's timeout was exceeded.
 	uint64_t completions {0};         // The handler returned without throwing.
 	uint64_t internal_errors {0};     // The handler threw a very bad exception.
+	std::unique_ptr<histogram> latency;  // Handler time in microseconds.
+
+	stats(const method &);
 };
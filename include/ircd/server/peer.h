@@ -27,6 +27,7 @@ struct ircd::server::peer
 	static conf::item<size_t> link_min_default;
 	static conf::item<size_t> link_max_default;
 	static conf::item<seconds> error_clear_default;
+	static conf::item<bool> session_resumption;
 	static uint64_t ids;
 
 	uint64_t id {++ids};
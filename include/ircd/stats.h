@@ -34,11 +34,18 @@
 /// words there is no reason to downcast to a value-level template when working
 /// with this system, and every value-level template must have a matching
 /// pointer-level parent.
+///
+/// In addition to scalar counters there is a histogram item which records a
+/// distribution of samples (usually a latency in microseconds) into log-linear
+/// buckets. Recording a sample is a few instructions and requires no
+/// allocation so it is appropriate for hot paths.
 namespace ircd::stats
 {
 	IRCD_EXCEPTION(ircd::error, error)
 	IRCD_EXCEPTION(error, not_found)
 
+	struct histogram;
+
 	// Abstract item
 	template<class T = void> struct item;
 	template<> struct item<void>;
@@ -47,11 +54,13 @@ namespace ircd::stats
 	template<> struct item<uint64_t *>;
 	template<> struct item<uint32_t *>;
 	template<> struct item<uint16_t *>;
+	template<> struct item<histogram *>;
 
 	// Value-carrying items
 	template<> struct item<uint64_t>;
 	template<> struct item<uint32_t>;
 	template<> struct item<uint16_t>;
+	template<> struct item<histogram>;
 
 	extern const size_t NAME_MAX_LEN;
 	extern std::map<string_view, item<void> *> items;
@@ -60,6 +69,30 @@ namespace ircd::stats
 	std::ostream &operator<<(std::ostream &, const item<void> &);
 }
 
+/// Log-linear histogram. Each power of two is divided into SUB linear
+/// sub-buckets, so the relative error of any bucket is at most 1/SUB. Values
+/// less than SUB each have their own bucket. The bucket array covers the
+/// entire range of uint64_t so there is no overflow bucket.
+struct ircd::stats::histogram
+{
+	static constexpr const size_t SUB_BITS {2};
+	static constexpr const size_t SUB {1UL << SUB_BITS};
+	static constexpr const size_t BUCKETS {(64 - SUB_BITS + 1) * SUB};
+
+	uint64_t bucket[BUCKETS] {0};
+	uint64_t count {0};
+	uint64_t sum {0};
+
+	static size_t index(const uint64_t &val) noexcept;
+	static uint64_t lower(const size_t &idx) noexcept;
+	static uint64_t upper(const size_t &idx) noexcept;
+
+	size_t last() const noexcept;
+	uint64_t percentile(const long double &) const noexcept;
+
+	void operator()(const uint64_t &val) noexcept;
+};
+
 /// Abstract stats item.
 ///
 /// This object contains type information about its derived class. There is no
@@ -175,6 +208,40 @@ struct ircd::stats::item<uint16_t *>
 	item() = default;
 };
 
+template<>
+struct ircd::stats::item<ircd::stats::histogram *>
+:item<void>
+{
+	histogram *val {nullptr};
+
+  public:
+	bool operator!() const override
+	{
+		return !val || !val->count;
+	}
+
+	operator const histogram &() const
+	{
+		assert(val);
+		return *val;
+	}
+
+	operator histogram &()
+	{
+		assert(val);
+		return *val;
+	}
+
+	void operator()(const uint64_t &sample) noexcept
+	{
+		assert(val);
+		(*val)(sample);
+	}
+
+	item(histogram *const &, const json::members &);
+	item() = default;
+};
+
 template<>
 struct ircd::stats::item<uint64_t>
 :item<uint64_t *>
@@ -237,3 +304,83 @@ struct ircd::stats::item<uint16_t>
 	item(const json::members &);
 	item() = default;
 };
+
+template<>
+struct ircd::stats::item<ircd::stats::histogram>
+:item<histogram *>
+{
+	histogram val;
+
+  public:
+	operator const histogram &() const noexcept
+	{
+		return val;
+	}
+
+	operator histogram &() noexcept
+	{
+		return val;
+	}
+
+	item(const json::members &);
+	item() = default;
+};
+
+inline void
+ircd::stats::histogram::operator()(const uint64_t &val)
+noexcept
+{
+	const auto idx
+	{
+		index(val)
+	};
+
+	assert(idx < BUCKETS);
+	bucket[idx]++;
+	count++;
+	sum += val;
+}
+
+inline uint64_t
+ircd::stats::histogram::upper(const size_t &idx)
+noexcept
+{
+	return idx + 1 < BUCKETS?
+		lower(idx + 1) - 1:
+		-1UL;
+}
+
+inline uint64_t
+ircd::stats::histogram::lower(const size_t &idx)
+noexcept
+{
+	if(idx < SUB)
+		return idx;
+
+	const size_t shift
+	{
+		idx / SUB - 1
+	};
+
+	return (SUB + idx % SUB) << shift;
+}
+
+inline size_t
+ircd::stats::histogram::index(const uint64_t &val)
+noexcept
+{
+	if(val < SUB)
+		return val;
+
+	const size_t msb
+	{
+		63UL - __builtin_clzl(val)
+	};
+
+	const size_t shift
+	{
+		msb - SUB_BITS
+	};
+
+	return (shift + 1) * SUB + ((val >> shift) & (SUB - 1));
+}
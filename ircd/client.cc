@@ -780,7 +780,7 @@ try
 
 	log::debug
 	{
-		resource::log, "%s HTTP %s `%s' content-length:%zu have:%zu",
+		resource::log, "%s HTTP %s `%s' content-length:%zu have:%zu"_fmt,
 		loghead(),
 		head.method,
 		head.path,
@@ -1057,7 +1057,7 @@ const
 
 	return fmt::sprintf
 	{
-		buf, "socket:%lu local:%s remote:%s client:%lu %s %lu:%lu",
+		buf, "socket:%lu local:%s remote:%s client:%lu %s %lu:%lu"_fmt,
 		sock? net::id(*sock) : -1UL,
 		string(locbuf, ircd::local(*this)),
 		string(rembuf, ircd::remote(*this)),
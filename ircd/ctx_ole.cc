@@ -20,7 +20,7 @@ namespace ircd::ctx::ole
 	bool termination;
 
 	static offload::function pop();
-	static void push(offload::function &&);
+	static void push(offload::function &&, const size_t &concurrency = 1);
 	static void worker() noexcept;
 }
 
@@ -29,6 +29,13 @@ ircd::ctx::ole::thread_max
 {
 	{ "name",     "ircd.ctx.ole.thread.max"  },
 	{ "default",  int64_t(1)                 },
+	{ "description",
+
+	R"(
+	Number of offload threads spawned as work is queued. An offload asking
+	for more concurrency in its opts spawns threads up to that number so its
+	shares run in parallel; e.g. the hash and signature checks of the vm.
+	)"},
 };
 
 ircd::ctx::ole::init::init()
@@ -62,38 +69,14 @@ ircd::ctx::ole::offload::offload(const opts &opts,
                                  const function &func)
 {
 	assert(current);
-	assert(opts.concurrency == 1); // not yet implemented
+	assert(opts.concurrency > 0);
 
 	// Prepare the offload package on our stack here. These objects will
-	// remain here for the duration of the offload.
-	latch latch{1};
-	std::exception_ptr eptr;
+	// remain here for the duration of the offload. Each thread executing the
+	// function has its own slot for an exception.
+	latch latch{opts.concurrency};
+	std::vector<std::exception_ptr> eptr(opts.concurrency);
 	auto *const context(current);
-	auto closure{[&func, &latch, &eptr, &context]
-	() noexcept
-	{
-		try
-		{
-			func();
-		}
-		catch(...)
-		{
-			// Note that the write to eptr is taking place on a different
-			// thread from where we created the eptr.
-			eptr = std::current_exception();
-		}
-
-		// The ctx::signal() is a special device which executes the closure
-		// as soon as the target context is not currently running on any
-		// thread. This has the ability to provide the cross-thread
-		// synchronization we need to hit the latch from this thread.
-		assert(context);
-		signal(*context, [&latch]
-		{
-			assert(!latch.is_ready());
-			latch.count_down();
-		});
-	}};
 
 	// interrupt(ctx) is suppressed while this context has offloaded some work
 	// to another thread. This context must stay right here and not disappear
@@ -101,20 +84,53 @@ ircd::ctx::ole::offload::offload(const opts &opts,
 	// capable of throwing an interrupt that was received during this scope.
 	const uninterruptible uninterruptible;
 
-	ole::push(std::move(closure));       // scope address required for clang-7
+	for(size_t i(0); i < opts.concurrency; ++i)
+	{
+		auto closure{[&func, &latch, &eptr, &context, i]
+		() noexcept
+		{
+			try
+			{
+				func();
+			}
+			catch(...)
+			{
+				// Note that the write to eptr is taking place on a different
+				// thread from where we created the eptr.
+				eptr[i] = std::current_exception();
+			}
+
+			// The ctx::signal() is a special device which executes the closure
+			// as soon as the target context is not currently running on any
+			// thread. This has the ability to provide the cross-thread
+			// synchronization we need to hit the latch from this thread.
+			assert(context);
+			signal(*context, [&latch]
+			{
+				assert(!latch.is_ready());
+				latch.count_down();
+			});
+		}};
+
+		ole::push(std::move(closure), opts.concurrency); // scope address required for clang-7
+	}
+
 	latch.wait();
 
 	// Don't throw any exception if there is a pending interrupt for this ctx.
 	// Two exceptions will be thrown in that case and if there's an interrupt
 	// we don't care about eptr anyway.
 	if(likely(!interruption_requested()))
-		if(unlikely(eptr))
-			std::rethrow_exception(eptr);
+		for(size_t i(0); i < opts.concurrency; ++i)
+			if(unlikely(eptr[i]))
+				std::rethrow_exception(eptr[i]);
 }
+
 void
-ircd::ctx::ole::push(offload::function &&func)
+ircd::ctx::ole::push(offload::function &&func,
+                     const size_t &concurrency)
 {
-	if(unlikely(threads.size() < size_t(thread_max)))
+	if(unlikely(threads.size() < std::max(size_t(thread_max), concurrency)))
 		threads.emplace_back(&worker);
 
 	const std::lock_guard lock
@@ -550,6 +550,20 @@ ircd::db::histogram_max
 decltype(ircd::db::prefetcher)
 ircd::db::prefetcher;
 
+decltype(ircd::db::prefetcher::batch_max)
+ircd::db::prefetcher::batch_max
+{
+	{ "name",     "ircd.db.prefetcher.batch.max" },
+	{ "default",  32L                            },
+	{ "description",
+
+	R"(
+	Maximum number of queued prefetches served by one database operation.
+	Point lookups for the same database are made with a single MultiGet;
+	prefetches into index columns are still made individually by seek.
+	)"},
+};
+
 //
 // db::prefetcher
 //
@@ -606,7 +620,19 @@ ircd::db::prefetcher::operator()(column &c,
 		return false;
 	}
 
-	queue.emplace_back(d, c, key);
+	const int8_t &ionice
+	{
+		ctx::current? ctx::ionice(ctx::cur()): int8_t(0)
+	};
+
+	const auto pri
+	{
+		test(opts, get::PRIO_HIGH) || ionice < 0?  prio::HIGH:
+		test(opts, get::PRIO_LOW) || ionice > 0?   prio::LOW:
+		                                            prio::NORMAL
+	};
+
+	queue.emplace_back(d, c, key, pri);
 	queue.back().snd = now<steady_point>();
 	ticker->request++;
 
@@ -756,30 +782,71 @@ ircd::db::prefetcher::request_worker()
 		request_cleanup()
 	};
 
-	// Find the first request in the queue which does not have its req
-	// timestamp sent.
-	auto request
+	// Find the highest priority class with any request in the queue which
+	// does not have its req timestamp sent.
+	uint8_t pri(prio::_NUM_);
+	for(const auto &request : queue)
+		if(request.req == steady_point::min() && request.prio < pri)
+			if((pri = request.prio) == prio::HIGH)
+				break;
+
+	if(pri == prio::_NUM_)
+		return;
+
+	// Take pending requests of that class for the same database in the
+	// order they were queued.
+	const size_t max
 	{
-		std::find_if(begin(queue), end(queue), []
-		(const auto &request)
-		{
-			return request.req == steady_point::min();
-		})
+		std::clamp(size_t(batch_max), 1UL, size_t(IOV_MAX))
 	};
 
-	if(request == end(queue))
-		return;
+	size_t num(0);
+	request *batch[max];
+	for(auto &request : queue)
+	{
+		if(num >= max)
+			break;
+
+		if(request.req != steady_point::min() || request.prio != pri)
+			continue;
+
+		if(num && request.d != batch[0]->d)
+			continue;
+
+		assert(request.fin == steady_point::min());
+		batch[num++] = &request;
+	}
 
+	assert(num);
 	assert(ticker);
-	assert(request->fin == steady_point::min());
-	request->req = now<steady_point>();
-	ticker->last_snd_req = duration_cast<microseconds>(request->req - request->snd);
-	ticker->accum_snd_req += ticker->last_snd_req;
+	const auto req
+	{
+		now<steady_point>()
+	};
 
-	ticker->fetches++;
-	request_handle(*request);
-	assert(request->fin != steady_point::min());
-	ticker->fetched++;
+	for(size_t i(0); i < num; ++i)
+	{
+		batch[i]->req = req;
+		ticker->last_snd_req = duration_cast<microseconds>(req - batch[i]->snd);
+		ticker->accum_snd_req += ticker->last_snd_req;
+	}
+
+	ticker->fetches += num;
+	ticker->batches++;
+	ticker->batch_size(num);
+	request_handle(vector_view<request *>(batch, num));
+	ticker->fetched += num;
+
+	for(size_t i(0); i < num; ++i)
+	{
+		assert(batch[i]->fin != steady_point::min());
+		const auto snd_fin
+		{
+			duration_cast<microseconds>(batch[i]->fin - batch[i]->snd).count()
+		};
+
+		ticker->latency[pri](std::max(snd_fin, 0L));
+	}
 
 	#ifdef IRCD_DB_DEBUG_PREFETCH
 	log::debug
@@ -809,6 +876,129 @@ noexcept
 	return removed;
 }
 
+/// Point lookups are made with one _read() for the whole batch, grouped by
+/// column. Requests into columns with a prefix transform are partial keys
+/// which a point lookup would miss (or skip by bloom filter), so these are
+/// still made by seek().
+void
+ircd::db::prefetcher::request_handle(const vector_view<request *> &batch_)
+{
+	vector_view<request *> batch
+	{
+		batch_
+	};
+
+	const auto is_point{[](const request *const &request)
+	{
+		assert(request->d);
+		const database::column &c((*request->d)[request->cid]);
+		return !c.prefix.user.has;
+	}};
+
+	auto *const point_end
+	{
+		std::stable_partition(begin(batch), end(batch), is_point)
+	};
+
+	std::sort(begin(batch), point_end, []
+	(const request *const &a, const request *const &b)
+	{
+		return a->cid < b->cid;
+	});
+
+	const size_t num
+	{
+		size_t(std::distance(begin(batch), point_end))
+	};
+
+	if(num == 1)
+		request_handle(*batch[0]);
+
+	else if(num > 1) try
+	{
+		_read_op op[num];
+		for(size_t i(0); i < num; ++i)
+			op[i] = _read_op
+			{
+				(*batch[i]->d)[batch[i]->cid], string_view(*batch[i])
+			};
+
+		const rocksdb::ReadOptions ropts
+		{
+			make_opts(gopts{})
+		};
+
+		_read({op, num}, ropts, [this]
+		(column &, const column::delta &delta, const rocksdb::Status &s)
+		{
+			if(s.ok())
+			{
+				ticker->fetched_bytes_key += size(std::get<column::delta::KEY>(delta));
+				ticker->fetched_bytes_val += size(std::get<column::delta::VAL>(delta));
+			}
+
+			return true;
+		});
+
+		const ctx::critical_assertion ca;
+		const auto fin
+		{
+			now<steady_point>()
+		};
+
+		for(size_t i(0); i < num; ++i)
+			batch[i]->fin = fin;
+
+		ticker->last_req_fin = duration_cast<microseconds>(fin - batch[0]->req);
+		ticker->accum_req_fin += ticker->last_req_fin * num;
+
+		#ifdef IRCD_DB_DEBUG_PREFETCH
+		char pbuf[1][32];
+		log::debug
+		{
+			log, "[%s] completed prefetch batch:%zu req-fin:%s queue:%zu",
+			name(*batch[0]->d),
+			num,
+			pretty(pbuf[0], fin - batch[0]->req, 1),
+			queue.size(),
+		};
+		#endif
+	}
+	catch(const std::exception &e)
+	{
+		const auto fin
+		{
+			now<steady_point>()
+		};
+
+		for(size_t i(0); i < num; ++i)
+			batch[i]->fin = fin;
+
+		log::error
+		{
+			log, "[%s] prefetch batch:%zu :%s",
+			name(*batch[0]->d),
+			num,
+			e.what(),
+		};
+	}
+	catch(...)
+	{
+		const auto fin
+		{
+			now<steady_point>()
+		};
+
+		for(size_t i(0); i < num; ++i)
+			batch[i]->fin = fin;
+
+		throw;
+	}
+
+	for(auto it(point_end); it != end(batch); ++it)
+		request_handle(**it);
+}
+
 void
 ircd::db::prefetcher::request_handle(request &request)
 try
@@ -903,13 +1093,45 @@ ircd::db::prefetcher::wait_pending()
 	return fetched_target - fetched_counter;
 }
 
+//
+// prefetcher::ticker
+//
+
+ircd::db::prefetcher::ticker::ticker()
+:batch_size
+{
+	{ "name", "ircd.db.prefetcher.batch.size" },
+	{ "desc", "Number of prefetches served by each database operation" },
+}
+,latency
+{
+	json::members
+	{
+		{ "name", "ircd.db.prefetcher.latency.high" },
+		{ "desc", "Microseconds from submission to completion of HIGH prefetches" },
+	},
+	json::members
+	{
+		{ "name", "ircd.db.prefetcher.latency.normal" },
+		{ "desc", "Microseconds from submission to completion of NORMAL prefetches" },
+	},
+	json::members
+	{
+		{ "name", "ircd.db.prefetcher.latency.low" },
+		{ "desc", "Microseconds from submission to completion of LOW prefetches" },
+	},
+}
+{
+}
+
 //
 // prefetcher::request
 //
 
 ircd::db::prefetcher::request::request(database &d,
                                        const column &c,
-                                       const string_view &key)
+                                       const string_view &key,
+                                       const enum prio &prio)
 noexcept
 :d
 {
@@ -921,7 +1143,11 @@ noexcept
 }
 ,len
 {
-	 uint32_t(std::min(size(key), sizeof(this->key)))
+	 uint16_t(std::min(size(key), sizeof(this->key)))
+}
+,prio
+{
+	prio
 }
 ,snd
 {
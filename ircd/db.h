@@ -324,6 +324,7 @@ ircd::db::database::stats final
 	std::array<uint64_t, NUM_TICKER> ticker {{0}};
 	std::array<ircd::stats::item<uint64_t *>, NUM_TICKER> item;
 	std::array<struct db::histogram, NUM_HISTOGRAM> histogram;
+	mutable std::mutex histogram_mutex; // executor threads; never held across a yield
 
 	// Additional custom stats
 	ircd::stats::item<uint64_t> get_copied;
@@ -379,6 +380,7 @@ ircd::db::database::column final
 	comparator cmp;
 	prefix_transform prefix;
 	compaction_filter cfilter;
+	std::shared_ptr<struct database::mergeop> mergeop;
 	std::shared_ptr<struct database::stats> stats;
 	std::shared_ptr<struct database::allocator> allocator;
 	rocksdb::BlockBasedTableOptions table_opts;
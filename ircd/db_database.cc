@@ -142,6 +142,48 @@ ircd::db::sort(database &d,
 	}
 }
 
+/// Ingest external SST files into several columns at once. Each pair is the
+/// name of a column and the path of a file created for it (see sst::build).
+/// The files are added atomically: either every column receives its file or
+/// none do, so the columns remain consistent with each other.
+void
+ircd::db::ingest(database &d,
+                 const vector_view<const std::pair<string_view, string_view>> &files)
+{
+	std::vector<rocksdb::IngestExternalFileArg> args(files.size());
+	for(size_t i(0); i < files.size(); ++i)
+	{
+		const auto &[colname, path]
+		{
+			files[i]
+		};
+
+		database::column &c(d[colname]);
+		const auto &copts{d.d->GetOptions(c)};
+		auto &arg(args[i]);
+		arg.column_family = c;
+		arg.external_files.emplace_back(path);
+		arg.options.allow_global_seqno = true;
+		arg.options.allow_blocking_flush = true;
+		arg.options.ingest_behind = copts.allow_ingest_behind;
+	}
+
+	log::debug
+	{
+		log, "[%s] @%lu INGEST %zu files",
+		name(d),
+		sequence(d),
+		files.size(),
+	};
+
+	const std::lock_guard lock{write_mutex};
+	const ctx::uninterruptible::nothrow ui;
+	throw_on_error
+	{
+		d.d->IngestExternalFiles(args)
+	};
+}
+
 void
 ircd::db::compact(database &d,
                   const compactor &cb)
@@ -1624,6 +1666,12 @@ ircd::db::database::column::column(database &d,
 ,cmp{this->d, this->descriptor->cmp}
 ,prefix{this->d, this->descriptor->prefix}
 ,cfilter{this, this->descriptor->compactor}
+,mergeop
+{
+	this->descriptor->merger?
+		std::make_shared<struct database::mergeop>(this->d, this->descriptor->merger):
+		nullptr
+}
 ,stats
 {
 	descriptor.name != "default"s?
@@ -1681,6 +1729,10 @@ ircd::db::database::column::column(database &d,
 	// Set the compaction filter
 	this->options.compaction_filter = &this->cfilter;
 
+	// Set the merge operator
+	if(this->mergeop)
+		this->options.merge_operator = this->mergeop;
+
 	//this->options.paranoid_file_checks = true;
 
 	// More stats reported by the rocksdb.stats property.
@@ -2205,6 +2257,12 @@ noexcept
 	if(startswith(str, "Options"))
 		return;
 
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			rog(level, "[%s] %s", d->name, str);
+		});
+
 	rog(level, "[%s] %s", d->name, str);
 }
 #ifdef __clang__
@@ -2361,7 +2419,14 @@ rocksdb::Status
 ircd::db::database::stats::Reset()
 noexcept
 {
-	ticker.fill(0);
+	for(auto &t : ticker)
+		__atomic_store_n(&t, 0UL, __ATOMIC_RELAXED);
+
+	const std::lock_guard lock
+	{
+		histogram_mutex
+	};
+
 	histogram.fill({0.0});
 	return rocksdb::Status::OK();
 }
@@ -2378,8 +2443,13 @@ ircd::db::database::stats::measureTime(const uint32_t type,
                                        const uint64_t time)
 noexcept
 {
-	auto &data(histogram.at(type));
+	// The executor threads of the env pools record here too.
+	const std::lock_guard lock
+	{
+		histogram_mutex
+	};
 
+	auto &data(histogram.at(type));
 	data.time += time;
 	data.hits++;
 
@@ -2393,6 +2463,11 @@ ircd::db::database::stats::histogramData(const uint32_t type,
 const noexcept
 {
 	assert(data);
+	const std::lock_guard lock
+	{
+		histogram_mutex
+	};
+
 	const auto &h
 	{
 		histogram.at(type)
@@ -2411,7 +2486,8 @@ ircd::db::database::stats::recordTick(const uint32_t type,
                                       const uint64_t count)
 noexcept
 {
-	ticker.at(type) += count;
+	// The executor threads of the env pools record here too.
+	__atomic_fetch_add(&ticker.at(type), count, __ATOMIC_RELAXED);
 }
 
 void
@@ -2419,23 +2495,21 @@ ircd::db::database::stats::setTickerCount(const uint32_t type,
                                           const uint64_t count)
 noexcept
 {
-	ticker.at(type) = count;
+	__atomic_store_n(&ticker.at(type), count, __ATOMIC_RELAXED);
 }
 
 uint64_t
 ircd::db::database::stats::getAndResetTickerCount(const uint32_t type)
 noexcept
 {
-	const auto ret(getTickerCount(type));
-	setTickerCount(type, 0);
-	return ret;
+	return __atomic_exchange_n(&ticker.at(type), 0UL, __ATOMIC_RELAXED);
 }
 
 uint64_t
 ircd::db::database::stats::getTickerCount(const uint32_t type)
 const noexcept
 {
-	return ticker.at(type);
+	return __atomic_load_n(&ticker.at(type), __ATOMIC_RELAXED);
 }
 
 ircd::string_view
@@ -2576,6 +2650,12 @@ ircd::db::database::events::OnFlushBegin(rocksdb::DB *const db,
                                          const rocksdb::FlushJobInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnFlushBegin(db, info);
+		});
+
 	log::debug
 	{
 		log, "[%s] job:%d ctx:%lu flushed start '%s' :%s",
@@ -2594,6 +2674,12 @@ ircd::db::database::events::OnFlushCompleted(rocksdb::DB *const db,
                                              const rocksdb::FlushJobInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnFlushCompleted(db, info);
+		});
+
 	const auto num_deletions
 	{
 		#if ROCKSDB_MAJOR > 5 \
@@ -2631,6 +2717,12 @@ ircd::db::database::events::OnCompactionCompleted(rocksdb::DB *const db,
                                                   const rocksdb::CompactionJobInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnCompactionCompleted(db, info);
+		});
+
 	using rocksdb::CompactionReason;
 
 	const log::level level
@@ -2712,6 +2804,12 @@ void
 ircd::db::database::events::OnTableFileDeleted(const rocksdb::TableFileDeletionInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnTableFileDeleted(info);
+		});
+
 	const log::level level
 	{
 		info.status == rocksdb::Status::OK()?
@@ -2736,6 +2834,12 @@ void
 ircd::db::database::events::OnTableFileCreated(const rocksdb::TableFileCreationInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnTableFileCreated(info);
+		});
+
 	const log::level level
 	{
 		info.status == rocksdb::Status::OK()?
@@ -2778,6 +2882,12 @@ void
 ircd::db::database::events::OnTableFileCreationStarted(const rocksdb::TableFileCreationBriefInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnTableFileCreationStarted(info);
+		});
+
 	log::debug
 	{
 		log, "[%s] job:%d table file opened [%s][%s] '%s'",
@@ -2793,6 +2903,12 @@ void
 ircd::db::database::events::OnMemTableSealed(const rocksdb::MemTableInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnMemTableSealed(info);
+		});
+
 	log::debug
 	{
 		log, "[%s] memory table sealed '%s' entries:%lu deletes:%lu",
@@ -2809,6 +2925,12 @@ void
 ircd::db::database::events::OnColumnFamilyHandleDeletionStarted(rocksdb::ColumnFamilyHandle *const h)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnColumnFamilyHandleDeletionStarted(h);
+		});
+
 	log::debug
 	{
 		log, "[%s] column[%s] handle closing @ %p",
@@ -2823,6 +2945,12 @@ ircd::db::database::events::OnExternalFileIngested(rocksdb::DB *const d,
                                                    const rocksdb::ExternalFileIngestionInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnExternalFileIngested(d, info);
+		});
+
 	log::notice
 	{
 		log, "[%s] external file ingested column[%s] external[%s] internal[%s] sequence:%lu",
@@ -2839,6 +2967,12 @@ ircd::db::database::events::OnBackgroundError(rocksdb::BackgroundErrorReason rea
                                               rocksdb::Status *const status)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnBackgroundError(reason, status);
+		});
+
 	assert(d);
 	assert(status);
 
@@ -2895,6 +3029,12 @@ void
 ircd::db::database::events::OnStallConditionsChanged(const rocksdb::WriteStallInfo &info)
 noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return OnStallConditionsChanged(info);
+		});
+
 	using rocksdb::WriteStallCondition;
 
 	const auto level
@@ -3221,6 +3361,12 @@ ircd::db::database::compaction_filter::FilterV2(const int level,
                                                 std::string *const skip)
 const noexcept
 {
+	if(unlikely(env::state::foreign()))
+		return env::state::marshal([&]
+		{
+			return FilterV2(level, key, type, oldval, newval, skip);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3608,6 +3754,64 @@ ircd::db::database::sst::dump::dump(db::column column,
 	this->info.version = info.version;
 }
 
+//
+// sst::build::build
+//
+
+ircd::db::database::sst::build::build(db::column column,
+                                      const string_view &path,
+                                      const vector_view<kv> &kvs)
+{
+	database::column &c(column);
+	const database &d(column);
+	const auto &less
+	{
+		c.cmp.user.less
+	};
+
+	assert(less);
+	std::sort(begin(kvs), end(kvs), [&less]
+	(const kv &a, const kv &b)
+	{
+		return less(a.first, b.first);
+	});
+
+	rocksdb::Options opts(d.d->GetOptions(c));
+	rocksdb::EnvOptions eopts(opts);
+	rocksdb::SstFileWriter writer
+	{
+		eopts, opts, c
+	};
+
+	throw_on_error
+	{
+		writer.Open(std::string{path})
+	};
+
+	for(const auto &[key, val] : kvs)
+		throw_on_error
+		{
+			writer.Put(slice(key), slice(val))
+		};
+
+	rocksdb::ExternalSstFileInfo info;
+	if(!kvs.empty())
+		throw_on_error
+		{
+			writer.Finish(&info)
+		};
+
+	this->info.column = db::name(column);
+	this->info.path = std::move(info.file_path);
+	this->info.min_key = std::move(info.smallest_key);
+	this->info.max_key = std::move(info.largest_key);
+	this->info.min_seq = info.sequence_number;
+	this->info.max_seq = info.sequence_number;
+	this->info.size = info.file_size;
+	this->info.entries = info.num_entries;
+	this->info.version = info.version;
+}
+
 //
 // sst::info::vector
 //
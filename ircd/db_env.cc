@@ -37,6 +37,12 @@ ircd::db::database::env::NewSequentialFile(const std::string &name,
                                            const EnvOptions &options)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return NewSequentialFile(name, r, options);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -69,6 +75,12 @@ ircd::db::database::env::NewRandomAccessFile(const std::string &name,
                                              const EnvOptions &options)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return NewRandomAccessFile(name, r, options);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -103,6 +115,12 @@ ircd::db::database::env::NewWritableFile(const std::string &name,
                                          const EnvOptions &options)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return NewWritableFile(name, r, options);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -142,6 +160,12 @@ ircd::db::database::env::ReopenWritableFile(const std::string &name,
                                             const EnvOptions &options)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return ReopenWritableFile(name, r, options);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -178,6 +202,12 @@ ircd::db::database::env::ReuseWritableFile(const std::string &name,
                                            const EnvOptions &options)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return ReuseWritableFile(name, old_name, r, options);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -217,6 +247,12 @@ ircd::db::database::env::NewRandomRWFile(const std::string &name,
                                          const EnvOptions &options)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return NewRandomRWFile(name, result, options);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -246,6 +282,12 @@ ircd::db::database::env::NewDirectory(const std::string &name,
                                       std::unique_ptr<Directory> *const result)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return NewDirectory(name, result);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -279,6 +321,12 @@ rocksdb::Status
 ircd::db::database::env::FileExists(const std::string &f)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return FileExists(f);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -306,6 +354,12 @@ ircd::db::database::env::GetChildren(const std::string &dir,
                                      std::vector<std::string> *const r)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetChildren(dir, r);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -333,6 +387,12 @@ ircd::db::database::env::GetChildrenFileAttributes(const std::string &dir,
                                                    std::vector<FileAttributes> *const result)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetChildrenFileAttributes(dir, result);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -359,6 +419,12 @@ rocksdb::Status
 ircd::db::database::env::DeleteFile(const std::string &name)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return DeleteFile(name);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -385,6 +451,12 @@ rocksdb::Status
 ircd::db::database::env::CreateDir(const std::string &name)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return CreateDir(name);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -411,6 +483,12 @@ rocksdb::Status
 ircd::db::database::env::CreateDirIfMissing(const std::string &name)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return CreateDirIfMissing(name);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -437,6 +515,12 @@ rocksdb::Status
 ircd::db::database::env::DeleteDir(const std::string &name)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return DeleteDir(name);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -464,6 +548,12 @@ ircd::db::database::env::GetFileSize(const std::string &name,
                                      uint64_t *const s)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetFileSize(name, s);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -493,6 +583,12 @@ ircd::db::database::env::GetFileModificationTime(const std::string &name,
                                                  uint64_t *const file_mtime)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetFileModificationTime(name, file_mtime);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -520,6 +616,12 @@ ircd::db::database::env::RenameFile(const std::string &s,
                                     const std::string &t)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return RenameFile(s, t);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -548,6 +650,12 @@ ircd::db::database::env::LinkFile(const std::string &s,
                                   const std::string &t)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return LinkFile(s, t);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -576,6 +684,12 @@ ircd::db::database::env::LockFile(const std::string &name,
                                   FileLock** l)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return LockFile(name, l);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -602,6 +716,12 @@ rocksdb::Status
 ircd::db::database::env::UnlockFile(FileLock *const l)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return UnlockFile(l);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -628,6 +748,12 @@ rocksdb::Status
 ircd::db::database::env::GetTestDirectory(std::string *const path)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetTestDirectory(path);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	return defaults.GetTestDirectory(path);
@@ -646,6 +772,12 @@ ircd::db::database::env::GetAbsolutePath(const std::string &db_path,
                                          std::string *const output_path)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetAbsolutePath(db_path, output_path);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -674,6 +806,12 @@ ircd::db::database::env::NewLogger(const std::string &name,
                                    std::shared_ptr<Logger> *const result)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return NewLogger(name, result);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -698,6 +836,12 @@ ircd::db::database::env::GetHostName(char *const name,
                                      uint64_t len)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetHostName(name, len);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -766,6 +910,12 @@ void
 ircd::db::database::env::SleepForMicroseconds(int micros)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return SleepForMicroseconds(micros);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -798,6 +948,12 @@ ircd::db::database::env::Schedule(void (*f)(void* arg),
                                   void (*u)(void* arg))
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Schedule(f, a, prio, tag, u);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	//#ifdef RB_DEBUG_DB_ENV
@@ -843,6 +999,12 @@ ircd::db::database::env::UnSchedule(void *const tag,
                                     const Priority prio)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return UnSchedule(tag, prio);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	//#ifdef RB_DEBUG_DB_ENV
@@ -882,6 +1044,12 @@ ircd::db::database::env::StartThread(void (*f)(void*),
                                      void *const a)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return StartThread(f, a);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	//#ifdef RB_DEBUG_DB_ENV
@@ -913,6 +1081,12 @@ void
 ircd::db::database::env::WaitForJoin()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return WaitForJoin();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -942,6 +1116,12 @@ unsigned int
 ircd::db::database::env::GetThreadPoolQueueLen(Priority prio)
 const noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetThreadPoolQueueLen(prio);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -976,6 +1156,12 @@ ircd::db::database::env::SetBackgroundThreads(int num,
                                               Priority prio)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return SetBackgroundThreads(num, prio);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -1013,6 +1199,12 @@ ircd::db::database::env::IncBackgroundThreadsIfNeeded(int num,
                                                       Priority prio)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return IncBackgroundThreadsIfNeeded(num, prio);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -1049,6 +1241,12 @@ void
 ircd::db::database::env::LowerThreadPoolIOPriority(Priority prio)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return LowerThreadPoolIOPriority(prio);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -1091,6 +1289,12 @@ rocksdb::Status
 ircd::db::database::env::GetThreadList(std::vector<ThreadStatus> *const list)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetThreadList(list);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -1127,6 +1331,12 @@ rocksdb::ThreadStatusUpdater *
 ircd::db::database::env::GetThreadStatusUpdater()
 const noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetThreadStatusUpdater();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -1156,6 +1366,12 @@ uint64_t
 ircd::db::database::env::GetThreadID()
 const noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetThreadID();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -1182,6 +1398,12 @@ int
 ircd::db::database::env::GetBackgroundThreads(Priority prio)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetBackgroundThreads(prio);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -1332,6 +1554,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file::Close()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Close();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1380,6 +1608,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file::Flush()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Flush();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1431,6 +1665,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file::Sync()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Sync();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1481,6 +1721,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file::Fsync()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Fsync();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1532,6 +1778,12 @@ ircd::db::database::env::writable_file::RangeSync(uint64_t offset,
                                                   uint64_t length)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return RangeSync(offset, length);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1598,6 +1850,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file::Truncate(uint64_t size)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Truncate(size);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1652,6 +1910,12 @@ ircd::db::database::env::writable_file::InvalidateCache(size_t offset,
                                                         size_t length)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return InvalidateCache(offset, length);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1706,6 +1970,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file::Append(const Slice &s)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Append(s);
+		});
+
 	assert(!opts.direct);
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
@@ -1769,6 +2039,12 @@ ircd::db::database::env::writable_file::PositionedAppend(const Slice &s,
                                                          uint64_t offset)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return PositionedAppend(s, offset);
+		});
+
 	assert(!opts.direct);
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
@@ -1836,6 +2112,12 @@ ircd::db::database::env::writable_file::Allocate(uint64_t offset,
                                                  uint64_t length)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Allocate(offset, length);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1895,6 +2177,12 @@ ircd::db::database::env::writable_file::PrepareWrite(size_t offset,
                                                      size_t length)
 noexcept
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return PrepareWrite(offset, length);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -1989,6 +2277,12 @@ ircd::db::database::env::writable_file::GetPreallocationStatus(size_t *const blo
                                                                size_t *const last_allocated_block)
 noexcept
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetPreallocationStatus(block_size, last_allocated_block);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -2013,6 +2307,12 @@ void
 ircd::db::database::env::writable_file::SetPreallocationBlockSize(size_t size)
 noexcept
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return SetPreallocationBlockSize(size);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -2033,6 +2333,12 @@ uint64_t
 ircd::db::database::env::writable_file::GetFileSize()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetFileSize();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -2142,6 +2448,12 @@ ircd::db::database::env::writable_file::GetUniqueId(char *const id,
                                                     size_t max_size)
 const noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetUniqueId(id, max_size);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -2226,6 +2538,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file_direct::Close()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Close();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -2282,6 +2600,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file_direct::Truncate(uint64_t size)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Truncate(size);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -2336,6 +2660,12 @@ rocksdb::Status
 ircd::db::database::env::writable_file_direct::Append(const Slice &s)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Append(s);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -2421,6 +2751,12 @@ ircd::db::database::env::writable_file_direct::PositionedAppend(const Slice &s,
                                                                 uint64_t offset)
 noexcept
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return PositionedAppend(s, offset);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -2447,6 +2783,12 @@ uint64_t
 ircd::db::database::env::writable_file_direct::GetFileSize()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetFileSize();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::lock_guard lock{mutex};
 
@@ -2915,6 +3257,12 @@ ircd::db::database::env::sequential_file::Read(size_t length,
                                                char *const scratch)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Read(length, result, scratch);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::unique_lock lock
 	{
@@ -3005,6 +3353,12 @@ ircd::db::database::env::sequential_file::PositionedRead(uint64_t offset,
                                                          char *const scratch)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return PositionedRead(offset, length, result, scratch);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::unique_lock lock
 	{
@@ -3091,6 +3445,12 @@ rocksdb::Status
 ircd::db::database::env::sequential_file::Skip(uint64_t size)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Skip(size);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 	const std::unique_lock lock
 	{
@@ -3139,6 +3499,12 @@ ircd::db::database::env::sequential_file::InvalidateCache(size_t offset,
                                                           size_t length)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return InvalidateCache(offset, length);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3297,6 +3663,12 @@ ircd::db::database::env::random_access_file::Prefetch(uint64_t offset,
                                                       size_t length)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Prefetch(offset, length);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3341,6 +3713,12 @@ ircd::db::database::env::random_access_file::MultiRead(rocksdb::ReadRequest *con
                                                        size_t num)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return MultiRead(req, num);
+		});
+
 	assert(req);
 	const ctx::uninterruptible::nothrow ui;
 
@@ -3460,6 +3838,12 @@ ircd::db::database::env::random_access_file::Read(uint64_t offset,
                                                   char *const scratch)
 const noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Read(offset, length, result, scratch);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	assert(result);
@@ -3534,6 +3918,12 @@ ircd::db::database::env::random_access_file::InvalidateCache(size_t offset,
                                                              size_t length)
 noexcept
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return InvalidateCache(offset, length);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3559,6 +3949,12 @@ ircd::db::database::env::random_access_file::GetUniqueId(char *const id,
                                                          size_t max_size)
 const noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return GetUniqueId(id, max_size);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3599,6 +3995,12 @@ void
 ircd::db::database::env::random_access_file::Hint(AccessPattern pattern)
 noexcept
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Hint(pattern);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3722,6 +4124,12 @@ rocksdb::Status
 ircd::db::database::env::random_rw_file::Close()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Close();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3766,6 +4174,12 @@ rocksdb::Status
 ircd::db::database::env::random_rw_file::Fsync()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Fsync();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3815,6 +4229,12 @@ rocksdb::Status
 ircd::db::database::env::random_rw_file::Sync()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Sync();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3864,6 +4284,12 @@ rocksdb::Status
 ircd::db::database::env::random_rw_file::Flush()
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Flush();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -3917,6 +4343,12 @@ ircd::db::database::env::random_rw_file::Read(uint64_t offset,
                                               char *const scratch)
 const noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Read(offset, length, result, scratch);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	assert(result);
@@ -3990,6 +4422,12 @@ ircd::db::database::env::random_rw_file::Write(uint64_t offset,
                                                const Slice &slice)
 noexcept try
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Write(offset, slice);
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -4088,6 +4526,12 @@ rocksdb::Status
 ircd::db::database::env::directory::Fsync()
 noexcept
 {
+	if(unlikely(state::foreign()))
+		return state::marshal([&]
+		{
+			return Fsync();
+		});
+
 	const ctx::uninterruptible::nothrow ui;
 
 	#ifdef RB_DEBUG_DB_ENV
@@ -4146,6 +4590,11 @@ noexcept
 // state::pool
 //
 
+namespace ircd::db
+{
+	static thread_local char namebuf_stats[128];
+}
+
 decltype(ircd::db::database::env::state::pool::stack_size)
 ircd::db::database::env::state::pool::stack_size
 {
@@ -4153,6 +4602,33 @@ ircd::db::database::env::state::pool::stack_size
 	{ "default",  long(128_KiB)                 },
 };
 
+decltype(ircd::db::database::env::state::pool::thread_count)
+ircd::db::database::env::state::pool::thread_count
+{
+	{ "name",     "ircd.db.env.pool.thread.count" },
+	{ "default",  0L                              },
+	{ "description",
+
+	R"(
+	Number of kernel threads executing background work for the LOW and BOTTOM
+	priority pools (compactions) of each database. When zero, all background
+	work takes place on the IRCd thread. Requires restart of the database.
+	)"},
+};
+
+decltype(ircd::db::database::env::state::pool::thread_affinity)
+ircd::db::database::env::state::pool::thread_affinity
+{
+	{ "name",     "ircd.db.env.pool.thread.affinity" },
+	{ "default",  string_view{}                      },
+	{ "description",
+
+	R"(
+	Comma-separated list of CPU numbers to which the background executor
+	threads are pinned. Empty for no affinity.
+	)"},
+};
+
 //
 // state::pool::pool
 //
@@ -4192,7 +4668,29 @@ ircd::db::database::env::state::pool::pool(database &d,
 	this->name,    // name of pool
 	this->popts    // pool options
 }
+,stats_queued
+{
+	{ "name", make_name(namebuf_stats, "queued")                   },
+	{ "desc", "Number of tasks waiting in the queue of this pool." },
+}
+,stats_tasks
 {
+	{ "name", make_name(namebuf_stats, "tasks")                    },
+	{ "desc", "Number of tasks executed by this pool."             },
+}
+,stats_run_time
+{
+	{ "name", make_name(namebuf_stats, "run_time")                 },
+	{ "desc", "Total microseconds spent executing tasks."          },
+}
+{
+	const bool executable
+	{
+		pri == Priority::LOW || pri == Priority::BOTTOM
+	};
+
+	if(executable && size_t(thread_count))
+		exec = std::make_unique<executor>(*this, size_t(thread_count));
 }
 
 ircd::db::database::env::state::pool::~pool()
@@ -4256,6 +4754,7 @@ ircd::db::database::env::state::pool::operator()(task &&task)
 	assert(task._id == 0);
 	task._id = ++taskctr;
 	tasks.emplace_back(std::move(task));
+	++stats_queued;
 
 	log::debug
 	{
@@ -4276,6 +4775,7 @@ ircd::db::database::env::state::pool::operator()(task &&task)
 		const ctx::uninterruptible::nothrow ui;
 		const auto task{std::move(tasks.front())};
 		tasks.pop_front();
+		--stats_queued;
 
 		log::debug
 		{
@@ -4297,7 +4797,7 @@ ircd::db::database::env::state::pool::operator()(task &&task)
 		};
 
 		// Execute the task
-		task.func(task.arg);
+		execute(task);
 
 		log::debug
 		{
@@ -4341,6 +4841,273 @@ ircd::db::database::env::state::pool::cancel(void *const &tag)
 		++i;
 	}
 
+	stats_queued -= i;
 	dock.notify_all();
 	return i;
 }
+
+void
+ircd::db::database::env::state::pool::execute(const task &task)
+{
+	const ircd::timer timer;
+	const unwind accounting{[this, &timer]
+	{
+		++stats_tasks;
+		stats_run_time += timer.at<microseconds>().count();
+	}};
+
+	if(!exec)
+		return task.func(task.arg);
+
+	// Hand the task to the executor and service its calls back to us here
+	// until it completes.
+	job job
+	{
+		task
+	};
+
+	(*exec)(job);
+	job.wait();
+}
+
+ircd::string_view
+ircd::db::database::env::state::pool::make_name(const mutable_buffer &buf,
+                                                const string_view &item_name)
+const
+{
+	return fmt::sprintf
+	{
+		buf, "ircd.db.%s.env.%s.%s",
+		d.name,
+		reflect(pri),
+		item_name,
+	};
+}
+
+//
+// state::pool::executor
+//
+
+ircd::db::database::env::state::pool::executor::executor(struct pool &pool,
+                                                         const size_t &count)
+:pool{pool}
+{
+	const string_view &cpus
+	{
+		thread_affinity
+	};
+
+	threads.reserve(count);
+	for(size_t i(0); i < count; ++i)
+	{
+		threads.emplace_back(&executor::worker, this);
+		if(!cpus.empty())
+			affinity(threads.back(), cpus);
+	}
+
+	log::debug
+	{
+		log, "[%s] pool:%s started %zu executor threads affinity:%s",
+		pool.d.name,
+		pool.name,
+		threads.size(),
+		cpus? cpus: "*"_sv,
+	};
+}
+
+ircd::db::database::env::state::pool::executor::~executor()
+noexcept
+{
+	{
+		const std::lock_guard lock
+		{
+			mutex
+		};
+
+		assert(queue.empty());
+		termination = true;
+		cond.notify_all();
+	}
+
+	for(auto &thread : threads)
+		thread.join();
+}
+
+void
+ircd::db::database::env::state::pool::executor::operator()(job &job)
+{
+	const std::lock_guard lock
+	{
+		mutex
+	};
+
+	queue.emplace_back(&job);
+	cond.notify_one();
+}
+
+void
+ircd::db::database::env::state::pool::executor::worker()
+noexcept
+{
+	while(auto *const next{pop()})
+	{
+		assert(!job::current);
+		job::current = next;
+		next->task.func(next->task.arg);
+		job::current = nullptr;
+		next->finish();
+	}
+}
+
+ircd::db::database::env::state::job *
+ircd::db::database::env::state::pool::executor::pop()
+{
+	std::unique_lock lock
+	{
+		mutex
+	};
+
+	cond.wait(lock, [this]
+	{
+		return !queue.empty() || termination;
+	});
+
+	if(queue.empty())
+		return nullptr;
+
+	auto *const ret
+	{
+		queue.front()
+	};
+
+	queue.pop_front();
+	return ret;
+}
+
+void
+ircd::db::database::env::state::pool::executor::affinity(std::thread &thread,
+                                                         const string_view &cpus)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	tokens(cpus, ',', [&set](const string_view &cpu)
+	{
+		CPU_SET(lex_cast<uint>(strip(cpu, ' ')), &set);
+	});
+
+	const int err
+	{
+		pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set)
+	};
+
+	if(unlikely(err))
+		log::error
+		{
+			log, "[%s] pool:%s executor affinity to '%s' :%s",
+			pool.d.name,
+			pool.name,
+			cpus,
+			std::error_code(err, std::system_category()).message(),
+		};
+}
+
+//
+// state::job
+//
+
+decltype(ircd::db::database::env::state::job::current)
+thread_local
+ircd::db::database::env::state::job::current;
+
+ircd::db::database::env::state::job::job(const struct task &task)
+:task{task}
+,context{ctx::current}
+{
+	assert(context);
+}
+
+ircd::db::database::env::state::job::~job()
+noexcept
+{
+	assert(done);
+	assert(!call);
+}
+
+/// Executor thread; post the call to the ctx worker and block until it has
+/// been performed.
+void
+ircd::db::database::env::state::job::operator()(const std::function<void ()> &func)
+{
+	assert(!ctx::current);
+	std::unique_lock lock
+	{
+		mutex
+	};
+
+	assert(!call);
+	call = &func;
+	ctx::signal(*context, [this]
+	{
+		dock.notify();
+	});
+
+	cond.wait(lock, [this]
+	{
+		return !call;
+	});
+}
+
+/// Executor thread; indicate the task has returned. The flag is set by the
+/// signal on the IRCd thread so the job cannot be destroyed by the ctx worker
+/// while any signal closure referring to it is still outstanding.
+void
+ircd::db::database::env::state::job::finish()
+noexcept
+{
+	ctx::signal(*context, [this]
+	{
+		done = true;
+		dock.notify();
+	});
+}
+
+/// ctx worker; perform calls from the executor until the task is done.
+void
+ircd::db::database::env::state::job::wait()
+{
+	assert(ctx::current == context);
+	while(1)
+	{
+		dock.wait([this]
+		{
+			return ready();
+		});
+
+		std::unique_lock lock
+		{
+			mutex
+		};
+
+		if(!call && done)
+			break;
+
+		assert(call);
+		const auto &func(*call);
+		lock.unlock();
+		func();
+		lock.lock();
+		call = nullptr;
+		cond.notify_all();
+	}
+}
+
+bool
+ircd::db::database::env::state::job::ready()
+{
+	const std::lock_guard lock
+	{
+		mutex
+	};
+
+	return call || done;
+}
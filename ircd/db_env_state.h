@@ -16,6 +16,7 @@ ircd::db::database::env::state
 {
 	struct task;
 	struct pool;
+	struct job;
 
 	static constexpr const size_t POOLS
 	{
@@ -25,6 +26,9 @@ ircd::db::database::env::state
 	database &d;
 	std::array<std::unique_ptr<pool>, POOLS> pool;
 
+	static bool foreign() noexcept;
+	template<class function> static auto marshal(function&&);
+
 	state(database *const &);
 	state(state &&) = delete;
 	state(const state &) = delete;
@@ -37,7 +41,11 @@ ircd::db::database::env::state::pool
 	using Priority = rocksdb::Env::Priority;
 	using IOPriority = rocksdb::Env::IOPriority;
 
+	struct executor;
+
 	static conf::item<size_t> stack_size;
+	static conf::item<size_t> thread_count;
+	static conf::item<std::string> thread_affinity;
 
 	database &d;
 	Priority pri;
@@ -49,6 +57,13 @@ ircd::db::database::env::state::pool
 	std::deque<task> tasks;
 	ctx::pool::opts popts;
 	ctx::pool p;
+	std::unique_ptr<executor> exec;
+	ircd::stats::item<uint64_t> stats_queued;
+	ircd::stats::item<uint64_t> stats_tasks;
+	ircd::stats::item<uint64_t> stats_run_time;
+
+	string_view make_name(const mutable_buffer &, const string_view &) const;
+	void execute(const task &);
 
 	size_t cancel(void *const &tag);
 	void operator()(task &&);
@@ -70,3 +85,96 @@ ircd::db::database::env::state::task
 	void *arg;
 	uint64_t _id {0};
 };
+
+/// Background executor comprised of real kernel threads for a pool. This is
+/// optional and only constructed for the LOW and BOTTOM priority pools when
+/// configured. The ctx worker of the pool hands its task to one of these
+/// threads so the CPU-bound work of a compaction (compression, block building,
+/// checksums) does not take time from the IRCd thread. The ctx worker remains
+/// waiting on the task's job to service any calls back into the env which
+/// require an ircd::ctx (i.e. file I/O via ircd::fs, port mutexes, logging).
+struct [[gnu::visibility("hidden")]]
+ircd::db::database::env::state::pool::executor
+{
+	struct pool &pool;
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::deque<job *> queue;
+	std::vector<std::thread> threads;
+	bool termination {false};
+
+	job *pop();
+	void worker() noexcept;
+	void affinity(std::thread &, const string_view &cpus);
+
+  public:
+	void operator()(job &);
+
+	executor(struct pool &, const size_t &count);
+	executor(executor &&) = delete;
+	executor(const executor &) = delete;
+	~executor() noexcept;
+};
+
+/// The exchange between a ctx worker of the pool and an executor thread for
+/// the duration of one task. This resides on the ctx worker's stack. Calls
+/// from the executor thread requiring an ircd::ctx are posted here and
+/// performed by the ctx worker while the executor thread waits.
+struct [[gnu::visibility("hidden")]]
+ircd::db::database::env::state::job
+{
+	static thread_local job *current;
+
+	const struct task &task;
+	ctx::ctx *context {nullptr};
+	ctx::dock dock;
+	std::mutex mutex;
+	std::condition_variable cond;
+	const std::function<void ()> *call {nullptr};
+	bool done {false};
+
+	bool ready();
+	void finish() noexcept;
+
+  public:
+	void operator()(const std::function<void ()> &);
+	void wait();
+
+	job(const struct task &);
+	job(job &&) = delete;
+	job(const job &) = delete;
+	~job() noexcept;
+};
+
+/// True when the caller is an executor thread; the env function must then
+/// marshal() itself back to the ctx worker rather than running here.
+inline bool
+ircd::db::database::env::state::foreign()
+noexcept
+{
+	return job::current != nullptr;
+}
+
+/// Perform the function on the ctx worker which owns the currently executing
+/// task; the calling executor thread blocks until it has returned.
+template<class function>
+inline auto
+ircd::db::database::env::state::marshal(function&& f)
+{
+	using return_type = decltype(f());
+
+	assert(job::current);
+	auto &current(*job::current);
+	if constexpr(std::is_same<return_type, void>())
+		current(f);
+	else
+	{
+		return_type ret {};
+		current([&ret, &f]
+		{
+			ret = f();
+		});
+
+		return ret;
+	}
+}
@@ -61,6 +61,12 @@ void
 rocksdb::port::Mutex::Lock()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return Lock();
+		});
+
 	if(unlikely(!ctx::current))
 		return;
 
@@ -80,6 +86,12 @@ void
 rocksdb::port::Mutex::Unlock()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return Unlock();
+		});
+
 	if(unlikely(!ctx::current))
 		return;
 
@@ -148,6 +160,12 @@ void
 rocksdb::port::RWMutex::ReadLock()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return ReadLock();
+		});
+
 	if(unlikely(!ctx::current))
 		return;
 
@@ -167,6 +185,12 @@ void
 rocksdb::port::RWMutex::WriteLock()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return WriteLock();
+		});
+
 	if(unlikely(!ctx::current))
 		return;
 
@@ -186,6 +210,12 @@ void
 rocksdb::port::RWMutex::ReadUnlock()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return ReadUnlock();
+		});
+
 	if(unlikely(!ctx::current))
 		return;
 
@@ -205,6 +235,12 @@ void
 rocksdb::port::RWMutex::WriteUnlock()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return WriteUnlock();
+		});
+
 	if(unlikely(!ctx::current))
 		return;
 
@@ -266,6 +302,12 @@ void
 rocksdb::port::CondVar::Wait()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return Wait();
+		});
+
 	assert(ctx::current);
 
 	#ifdef RB_DEBUG_DB_PORT
@@ -287,6 +329,12 @@ bool
 rocksdb::port::CondVar::TimedWait(uint64_t abs_time_us)
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return TimedWait(abs_time_us);
+		});
+
 	assert(ctx::current);
 
 	#ifdef RB_DEBUG_DB_PORT
@@ -309,6 +357,12 @@ void
 rocksdb::port::CondVar::Signal()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return Signal();
+		});
+
 	#ifdef RB_DEBUG_DB_PORT
 	log::debug
 	{
@@ -324,6 +378,12 @@ void
 rocksdb::port::CondVar::SignalAll()
 noexcept
 {
+	if(unlikely(db::database::env::state::foreign()))
+		return db::database::env::state::marshal([&]
+		{
+			return SignalAll();
+		});
+
 	#ifdef RB_DEBUG_DB_PORT
 	log::debug
 	{
@@ -390,6 +390,48 @@ catch(const std::out_of_range &e)
 	};
 }
 
+/// Precompiled path. The directives were parsed and the arguments checked
+/// at compile time (see fmt::literal) so this only generates the output.
+ircd::fmt::snprintf::snprintf(internal_t,
+                              const mutable_buffer &out,
+                              const compiled &fmt,
+                              const va_rtti &v)
+:out{out}
+,fmt{}
+,idx{0}
+{
+	if(unlikely(empty(out)))
+		return;
+
+	auto it(begin(v));
+	for(const auto &d : fmt.directives)
+	{
+		if(unlikely(!remaining()))
+			break;
+
+		append(fmt.format.substr(d.pos, d.len));
+		if(!d.name[0])
+			continue;
+
+		assert(size_t(idx) < v.size());
+		fmt::spec spec;
+		spec.sign = d.sign;
+		spec.pad = d.pad;
+		spec.width = d.width;
+		spec.precision = d.precision;
+		spec.name = string_view{d.name};
+
+		const void *const &ptr(get<0>(*it));
+		const std::type_index type(*get<1>(*it));
+		handle_specifier(this->out, idx++, spec, std::make_tuple(ptr, type));
+		++it;
+	}
+
+	assert(size(this->out) > 0);
+	assert(this->out.remaining());
+	copy(mutable_buffer(this->out), '\0');
+}
+
 void
 ircd::fmt::snprintf::argument(const arg &val)
 {
@@ -499,6 +499,7 @@ ircd::fs::aio::request::submit()
 	assert(ctx::current);
 
 	// Update stats for submission phase
+	submitted = now<steady_point>();
 	const size_t submitted_bytes(bytes(iovec()));
 	stats.bytes_requests += submitted_bytes;
 	stats.requests++;
@@ -529,6 +530,19 @@ ircd::fs::aio::request::complete()
 	stats.bytes_complete += submitted_bytes;
 	stats.complete++;
 
+	const auto elapsed
+	{
+		duration_cast<microseconds>(now<steady_point>() - submitted).count()
+	};
+
+	switch(translate(aio_lio_opcode))
+	{
+		case op::READ:   latency_read(elapsed);   break;
+		case op::WRITE:  latency_write(elapsed);  break;
+		case op::SYNC:   latency_sync(elapsed);   break;
+		default:                                  break;
+	}
+
 	if(likely(retval != -1))
 		return size_t(retval);
 
@@ -31,6 +31,10 @@ namespace ircd::fs::aio
 	size_t read(const vector_view<read_op> &);
 	size_t read(const fd &, const const_iovec_view &, const read_opts &);
 	size_t fsync(const fd &, const sync_opts &);
+
+	extern ircd::stats::item<ircd::stats::histogram> latency_read;
+	extern ircd::stats::item<ircd::stats::histogram> latency_write;
+	extern ircd::stats::item<ircd::stats::histogram> latency_sync;
 }
 
 /// AIO context instance from the system. Right now this is a singleton with
@@ -127,6 +131,7 @@ struct ircd::fs::aio::request
 	ssize_t errcode;
 	const struct opts *opts;
 	ctx::dock *waiter;
+	steady_point submitted;
 
 	bool wait();
 
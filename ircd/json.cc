@@ -2820,6 +2820,136 @@ ircd::json::object::const_iterator::operator++()
 	return *this;
 }
 
+//
+// object::index
+//
+
+ircd::json::object::index::index(const json::object &object)
+:object
+{
+	object
+}
+{
+	const char *const base
+	{
+		this->object.data()
+	};
+
+	for(auto it(this->object.begin()); it != this->object.end(); ++it)
+	{
+		if(unlikely(count >= MAX))
+		{
+			overflow = true;
+			break;
+		}
+
+		const auto &[key, val]
+		{
+			*it
+		};
+
+		auto &e(ent[count]);
+		e.hash = name_hash(key);
+		e.key = std::distance(base, key.data());
+		e.key_len = key.size();
+		e.val = std::distance(base, val.data());
+		e.val_len = val.size();
+		sorted[count] = count;
+		++count;
+	}
+
+	// Stable so the first of any duplicate keys sorts first.
+	std::stable_sort(sorted, sorted + count, [this]
+	(const uint8_t &a, const uint8_t &b)
+	{
+		return ent[a].hash < ent[b].hash;
+	});
+}
+
+ircd::string_view
+ircd::json::object::index::operator[](const string_view &key)
+const
+{
+	return get(key);
+}
+
+ircd::string_view
+ircd::json::object::index::at(const string_view &key)
+const
+{
+	const auto e
+	{
+		find(name_hash(key), key)
+	};
+
+	if(likely(e))
+		return string_view
+		{
+			object.data() + e->val, e->val_len
+		};
+
+	if(unlikely(overflow))
+		return object.at(key);
+
+	throw not_found
+	{
+		"'%s'", key
+	};
+}
+
+ircd::string_view
+ircd::json::object::index::get(const string_view &key,
+                               const string_view &def)
+const
+{
+	const auto e
+	{
+		find(name_hash(key), key)
+	};
+
+	if(likely(e))
+		return string_view
+		{
+			object.data() + e->val, e->val_len
+		};
+
+	if(unlikely(overflow))
+		return object.get(key, def);
+
+	return def;
+}
+
+bool
+ircd::json::object::index::has(const string_view &key)
+const
+{
+	return find(name_hash(key), key) || (overflow && object.has(key));
+}
+
+const ircd::json::object::index::entry *
+ircd::json::object::index::find(const name_hash_t &hash,
+                                const string_view &key)
+const
+{
+	auto it
+	{
+		std::lower_bound(sorted, sorted + count, hash, [this]
+		(const uint8_t &a, const name_hash_t &hash)
+		{
+			return ent[a].hash < hash;
+		})
+	};
+
+	for(; it != sorted + count && ent[*it].hash == hash; ++it)
+	{
+		const auto &e(ent[*it]);
+		if(likely(string_view(object.data() + e.key, e.key_len) == key))
+			return &e;
+	}
+
+	return nullptr;
+}
+
 //
 // object::member
 //
@@ -15,6 +15,7 @@
 namespace ircd::log
 {
 	struct confs;
+	struct writer;
 
 	static bool is_conf_mask_file(const string_view &name);
 	static bool is_conf_mask_console(const string_view &name);
@@ -34,7 +35,9 @@ namespace ircd::log
 	extern conf::item<std::string> unmask_console;
 	extern conf::item<std::string> mask_file;
 	extern conf::item<std::string> mask_console;
+	extern conf::item<bool> file_async;
 	extern std::array<std::ofstream, num_of<level>()> file;
+	extern struct writer writer;
 	extern std::array<ulong, num_of<level>()> console_quiet_stdout;
 	extern std::array<ulong, num_of<level>()> console_quiet_stderr;
 	std::ostream &out_console{std::cout};
@@ -50,6 +53,45 @@ struct ircd::log::confs
 	conf::item<bool> console_flush;
 };
 
+/// Asynchronous file output. The main thread copies each formatted message
+/// into a ring and a dedicated thread writes them out to the file of their
+/// level in batches. The main thread is the only producer and the consumer
+/// always holds the mutex, so the ring itself takes no lock. A message which
+/// doesn't fit in the ring is dropped and counted; the count is reported in
+/// the WARNING file once there's room again. CRITICAL messages drain the ring
+/// and are written (and flushed) synchronously by the main thread.
+struct ircd::log::writer
+{
+	static constexpr const size_t RING_SIZE {1_MiB};
+	static constexpr const size_t HEADER_SIZE {sizeof(uint32_t)};
+	static_assert(RING_SIZE && !(RING_SIZE & (RING_SIZE - 1)));
+
+	std::unique_ptr<char[]> ring;
+	std::atomic<size_t> head {0};
+	std::atomic<size_t> tail {0};
+	std::atomic<size_t> dropped {0};
+	std::atomic<bool> sleeping {false};
+	std::atomic<bool> interrupted {false};
+	std::mutex mutex;
+	std::mutex cond_mutex;
+	std::condition_variable cond;
+	std::thread thread;
+
+	void copy(const size_t &pos, const const_buffer &) noexcept;
+	void copy(const mutable_buffer &, const size_t &pos) const noexcept;
+	void worker() noexcept;
+
+  public:
+	explicit operator bool() const noexcept;
+
+	size_t drain() noexcept;
+	bool push(const level &, const string_view &) noexcept;
+	void start();
+	void stop() noexcept;
+
+	~writer() noexcept;
+};
+
 /// Linkage for list of named loggers.
 template<>
 decltype(ircd::instance_list<ircd::log::log>::allocator)
@@ -66,6 +108,23 @@ ircd::instance_list<ircd::log::log>::list
 decltype(ircd::log::file)
 ircd::log::file;
 
+decltype(ircd::log::writer)
+ircd::log::writer;
+
+decltype(ircd::log::file_async)
+ircd::log::file_async
+{
+	{ "name",     "ircd.log.file.async" },
+	{ "default",  true                  },
+	{ "description",
+
+	R"(
+	Write log files from a dedicated thread rather than the main thread.
+	CRITICAL messages are always written synchronously. Takes effect at
+	startup.
+	)"},
+};
+
 decltype(ircd::log::console_quiet_stdout)
 ircd::log::console_quiet_stdout;
 
@@ -140,6 +199,8 @@ ircd::log::init()
 	{
 		mkdir();
 		open();
+		if(file_async)
+			writer.start();
 	}
 
 	ircd::log::ready = true;
@@ -148,6 +209,7 @@ ircd::log::init()
 void
 ircd::log::fini()
 {
+	writer.stop();
 	flush();
 	close();
 }
@@ -166,6 +228,12 @@ ircd::log::mkdir()
 void
 ircd::log::open()
 {
+	const std::lock_guard lock
+	{
+		writer.mutex
+	};
+
+	writer.drain();
 	for_each<level>([](const level &lev)
 	{
 		if(file[lev].is_open())
@@ -180,6 +248,12 @@ ircd::log::open()
 void
 ircd::log::close()
 {
+	const std::lock_guard lock
+	{
+		writer.mutex
+	};
+
+	writer.drain();
 	for_each<level>([](const level &lev)
 	{
 		if(file[lev].is_open())
@@ -190,6 +264,12 @@ ircd::log::close()
 void
 ircd::log::flush()
 {
+	const std::lock_guard lock
+	{
+		writer.mutex
+	};
+
+	writer.drain();
 	for_each<level>([](const level &lev)
 	{
 		file[lev].flush();
@@ -489,6 +569,23 @@ ircd::log::vlog::vlog(const log &log,
 	});
 }
 
+ircd::log::vlog::vlog(const log &log,
+                      const level &lev,
+                      const fmt::compiled &fmt,
+                      const va_rtti &ap)
+{
+	if(!is_main_thread() && likely(ios::available()))
+	{
+		vlog_threadsafe(log, lev, fmt.format, ap);
+		return;
+	}
+
+	slog(log, lev, [&fmt, &ap](const mutable_buffer &out) -> size_t
+	{
+		return fmt::vsprintf(out, fmt, ap);
+	});
+}
+
 namespace ircd::log
 {
 	bool entered;
@@ -658,6 +755,19 @@ noexcept
 	if(!copy_to_file || !msg)
 		return;
 
+	if(lev != level::CRITICAL && writer)
+	{
+		writer.push(lev, msg);
+		return;
+	}
+
+	// Anything still queued is written first to keep the order of the file.
+	const std::lock_guard lock
+	{
+		writer.mutex
+	};
+
+	writer.drain();
 	file[lev].clear();
 	check(file[lev]);
 	file[lev].write(data(msg), size(msg));
@@ -665,6 +775,199 @@ noexcept
 		file[lev].flush();
 }
 
+//
+// writer
+//
+
+ircd::log::writer::~writer()
+noexcept
+{
+	stop();
+}
+
+void
+ircd::log::writer::start()
+{
+	assert(!thread.joinable());
+	if(!ring)
+		ring = std::make_unique<char[]>(RING_SIZE);
+
+	interrupted = false;
+	thread = std::thread
+	{
+		&writer::worker, this
+	};
+}
+
+void
+ircd::log::writer::stop()
+noexcept
+{
+	if(!thread.joinable())
+		return;
+
+	interrupted = true;
+	cond.notify_all();
+	thread.join();
+}
+
+void
+ircd::log::writer::worker()
+noexcept
+{
+	while(!interrupted)
+	{
+		{
+			std::unique_lock lock
+			{
+				cond_mutex
+			};
+
+			// The timeout is a backstop for a notification which raced
+			// this check; the producer doesn't take cond_mutex.
+			sleeping = true;
+			if(head == tail && !interrupted)
+				cond.wait_for(lock, 100ms);
+
+			sleeping = false;
+		}
+
+		const std::lock_guard lock
+		{
+			mutex
+		};
+
+		drain();
+	}
+
+	const std::lock_guard lock
+	{
+		mutex
+	};
+
+	drain();
+}
+
+/// Writes everything in the ring to the files; the caller must hold the
+/// mutex. Returns the number of messages written.
+size_t
+ircd::log::writer::drain()
+noexcept
+{
+	if(!ring)
+		return 0;
+
+	bool flush[num_of<level>()] {false};
+	size_t ret(0), pos(tail.load(std::memory_order_relaxed));
+	for(const size_t end(head); pos < end; ++ret)
+	{
+		uint32_t header;
+		copy(mutable_buffer{reinterpret_cast<char *>(&header), HEADER_SIZE}, pos);
+		const auto lev(level(header >> 24));
+		const size_t len(header & 0x00ffffffU);
+		const size_t off((pos + HEADER_SIZE) & (RING_SIZE - 1));
+		const size_t first(std::min(len, RING_SIZE - off));
+		pos += HEADER_SIZE + len;
+
+		auto &file(ircd::log::file.at(size_t(lev)));
+		if(!file.is_open())
+			continue;
+
+		file.clear();
+		check(file);
+		file.write(ring.get() + off, first);
+		file.write(ring.get(), len - first);
+		flush[size_t(lev)] |= bool(confs.at(size_t(lev)).file_flush);
+	}
+
+	tail.store(pos, std::memory_order_release);
+	if(const size_t dropped{this->dropped.exchange(0)})
+	{
+		auto &file(ircd::log::file.at(size_t(level::WARNING)));
+		char buf[128];
+		const size_t len
+		{
+			size_t(::snprintf(buf, sizeof(buf), "log: %zu messages dropped; output buffer full.\r\n", dropped))
+		};
+
+		if(file.is_open())
+		{
+			file.clear();
+			check(file);
+			file.write(buf, std::min(len, sizeof(buf) - 1));
+			flush[size_t(level::WARNING)] = true;
+		}
+	}
+
+	for(size_t i(0); i < num_of<level>(); ++i)
+		if(flush[i])
+			ircd::log::file.at(i).flush();
+
+	return ret;
+}
+
+bool
+ircd::log::writer::push(const level &lev,
+                        const string_view &msg)
+noexcept
+{
+	assert(ring);
+	assert(size(msg) <= 0x00ffffffU);
+	const size_t need
+	{
+		HEADER_SIZE + size(msg)
+	};
+
+	const size_t pos(head.load(std::memory_order_relaxed));
+	if(RING_SIZE - (pos - tail.load(std::memory_order_acquire)) < need)
+	{
+		++dropped;
+		return false;
+	}
+
+	const uint32_t header
+	{
+		uint32_t(lev) << 24 | uint32_t(size(msg))
+	};
+
+	copy(pos, const_buffer{reinterpret_cast<const char *>(&header), HEADER_SIZE});
+	copy(pos + HEADER_SIZE, msg);
+	head = pos + need;
+	if(sleeping)
+		cond.notify_one();
+
+	return true;
+}
+
+void
+ircd::log::writer::copy(const size_t &pos,
+                        const const_buffer &buf)
+noexcept
+{
+	const size_t off(pos & (RING_SIZE - 1));
+	const size_t first(std::min(size(buf), RING_SIZE - off));
+	memcpy(ring.get() + off, data(buf), first);
+	memcpy(ring.get(), data(buf) + first, size(buf) - first);
+}
+
+void
+ircd::log::writer::copy(const mutable_buffer &buf,
+                        const size_t &pos)
+const noexcept
+{
+	const size_t off(pos & (RING_SIZE - 1));
+	const size_t first(std::min(size(buf), RING_SIZE - off));
+	memcpy(data(buf), ring.get() + off, first);
+	memcpy(data(buf) + first, ring.get(), size(buf) - first);
+}
+
+ircd::log::writer::operator
+bool()
+const noexcept
+{
+	return thread.joinable() && !interrupted;
+}
+
 decltype(ircd::log::log_to_stdout)
 ircd::log::log_to_stdout
 {
@@ -93,7 +93,9 @@ ircd::magick::yield_interval
 // simultaneously. This race is possible if the progress callback yields
 // and another context starts an operation. It is highly unlikely the lib
 // can handle reentrancy on the same thread. Hitting thread mutexes within
-// magick will also be catastrophic to ircd::ctx.
+// magick will also be catastrophic to ircd::ctx. Calls made off the ircd::ctx
+// system (i.e. from ctx::offload threads) don't take this mutex; the library
+// is thread-safe and those calls can't yield.
 decltype(ircd::magick::call_mutex)
 ircd::magick::call_mutex;
 
@@ -499,11 +501,14 @@ ircd::magick::callex(function&& f,
 			"Graphics library not ready."
 		};
 
-	const std::lock_guard lock
+	std::unique_lock lock
 	{
-		call_mutex
+		call_mutex, std::defer_lock
 	};
 
+	if(ctx::current)
+		lock.lock();
+
 	ExceptionInfo ei;
 	GetExceptionInfo(&ei); // initializer
 	const unwind destroy{[&ei]
@@ -517,19 +522,15 @@ ircd::magick::callex(function&& f,
 		f(std::forward<args>(a)..., &ei)
 	};
 
-	const auto their_handler
-	{
-		SetErrorHandler(handle_exception)
-	};
+	// The ExceptionInfo is inspected here rather than swapping the library's
+	// global error handler around CatchException(), which is not safe with
+	// calls made from several threads.
+	if(ei.severity >= ErrorException)
+		handle_exception(ei.severity, ei.reason?: "", ei.description?: "");
 
-	const unwind reset{[&their_handler]
-	{
-		SetErrorHandler(their_handler);
-	}};
+	if(ei.severity >= WarningException)
+		handle_warning(ei.severity, ei.reason?: "", ei.description?: "");
 
-	// exception comes out of here; if this is not safe we'll have to
-	// convey with a global or inspect ExceptionInfo manually.
-	CatchException(&ei);
 	return ret;
 }
 
@@ -556,11 +557,14 @@ ircd::magick::call(function&& f,
 			"Graphics library not ready."
 		};
 
-	const std::lock_guard lock
+	std::unique_lock lock
 	{
-		call_mutex
+		call_mutex, std::defer_lock
 	};
 
+	if(ctx::current)
+		lock.lock();
+
 	assert(call_ready);
 	return f(std::forward<args>(a)...);
 }
@@ -605,7 +609,9 @@ noexcept try
 	// and monotonically increases across jobs as well.
 	const auto cycles_sample
 	{
-		ctx::this_ctx::cycles()
+		ctx::current?
+			ctx::this_ctx::cycles():
+			prof::cycles()
 	};
 
 	// Detect if this is a new job. Tick is usually zero for a new job, but for
@@ -721,6 +727,10 @@ ircd::magick::check_yield(job &job)
 		magick::yield_threshold
 	};
 
+	// Jobs running off the ircd::ctx system (i.e. offloaded) never yield.
+	if(!ctx::current)
+		return false;
+
 	// This job is too small to conduct any yields.
 	if(likely(job.ticks < yield_threshold))
 		return false;
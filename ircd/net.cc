@@ -65,12 +65,15 @@ ircd::net::init_ipv6()
 // init
 //
 
+static int ircd_net_socket_new_session(SSL *, SSL_SESSION *) noexcept;
+
 /// Network subsystem initialization
 ircd::net::init::init()
 {
 	init_ipv6();
 	sslv23_client.set_verify_mode(asio::ssl::verify_peer);
 	sslv23_client.set_default_verify_paths();
+	openssl::set_session_cache(*sslv23_client.native_handle(), ircd_net_socket_new_session);
 	_dns_.emplace();
 }
 
@@ -1201,6 +1204,20 @@ ircd::net::socket::total_calls_out
 	{ "desc", "The total number of write operations on all sockets"  },
 };
 
+decltype(ircd::net::socket::handshake_full)
+ircd::net::socket::handshake_full
+{
+	{ "name", "ircd.net.socket.handshake.full"                       },
+	{ "desc", "The number of outbound TLS handshakes without resumption" },
+};
+
+decltype(ircd::net::socket::handshake_resumed)
+ircd::net::socket::handshake_resumed
+{
+	{ "name", "ircd.net.socket.handshake.resumed"                    },
+	{ "desc", "The number of outbound TLS handshakes resuming a session" },
+};
+
 //
 // socket
 //
@@ -1319,6 +1336,16 @@ ircd::net::socket::handshake(const open_opts &opts,
 	if(opts.send_sni && server_name(opts))
 		openssl::server_name(*this, server_name(opts));
 
+	// The session is shared with the user through the opts; the new session
+	// callback finds it from the SSL's app data.
+	session = opts.session;
+	if(session)
+	{
+		openssl::set_app_data(*this, this);
+		if(!session->empty() && !openssl::set_session(*this, const_buffer{*session}))
+			session->clear();
+	}
+
 	ssl.set_verify_callback(std::move(verify_handler));
 	ssl.async_handshake(handshake_type::client, ios::handle(desc_handshake, std::move(handshake_handler)));
 }
@@ -2236,6 +2263,9 @@ noexcept try
 	if(!ec)
 		blocking(*this, false);
 
+	if(!ec)
+		++(openssl::session_reused(*this)? handshake_resumed: handshake_full);
+
 	// This is the end of the asynchronous call chain; the user is called
 	// back with or without error here.
 	call_user(callback, ec);
@@ -2275,6 +2305,47 @@ catch(const std::exception &e)
 	call_user(callback, ec);
 }
 
+/// OpenSSL calls this for each session the server issues on a connection
+/// we opened; with TLS 1.3 that's after the handshake, as tickets arrive
+/// with the first reads.
+int
+ircd_net_socket_new_session(SSL *const ssl,
+                            SSL_SESSION *const sess)
+noexcept try
+{
+	using namespace ircd;
+
+	assert(ssl && sess);
+	auto *const socket
+	{
+		static_cast<net::socket *>(openssl::get_app_data(*ssl))
+	};
+
+	if(!socket || !socket->session)
+		return 0;
+
+	thread_local char buf[16_KiB];
+	const string_view session
+	{
+		openssl::get_session(buf, *sess)
+	};
+
+	if(session)
+		socket->session->assign(data(session), size(session));
+
+	return 0;
+}
+catch(const std::exception &e)
+{
+	ircd::log::error
+	{
+		ircd::net::log, "new session :%s",
+		e.what(),
+	};
+
+	return 0;
+}
+
 bool
 ircd::net::socket::handle_verify(const bool valid,
                                  asio::ssl::verify_context &vc,
@@ -19,6 +19,43 @@ ircd::net::listen
 	{ "persist",  false             },
 };
 
+/// Threads which conduct the server side of TLS handshakes on their own
+/// io_context, so the key exchange and signature work for a surge of new
+/// connections doesn't occupy the main thread. The descriptor of a socket is
+/// moved onto this io_context and the handshake runs asynchronously, so a
+/// peer which stalls holds no thread. The main thread doesn't touch the
+/// socket until it is moved back with the result; the timeout and any
+/// interruption shut down the descriptor rather than cancelling the socket.
+namespace ircd::net::handshake_pool
+{
+	using work_guard = asio::executor_work_guard<asio::io_context::executor_type>;
+
+	extern asio::io_context context;
+	extern std::optional<work_guard> work;
+	extern std::vector<std::thread> threads;
+	extern std::map<const socket *, int> active;
+	extern size_t acceptors;
+
+	static void worker() noexcept;
+	static void start();
+	static void stop() noexcept;
+}
+
+decltype(ircd::net::handshake_pool::context)
+ircd::net::handshake_pool::context;
+
+decltype(ircd::net::handshake_pool::work)
+ircd::net::handshake_pool::work;
+
+decltype(ircd::net::handshake_pool::threads)
+ircd::net::handshake_pool::threads;
+
+decltype(ircd::net::handshake_pool::active)
+ircd::net::handshake_pool::active;
+
+decltype(ircd::net::handshake_pool::acceptors)
+ircd::net::handshake_pool::acceptors;
+
 bool
 ircd::net::stop(acceptor &a)
 {
@@ -272,6 +309,27 @@ ircd::net::acceptor::ssl_cipher_blacklist
 	{ "default",  string_view{ircd::net::ssl_cipher_blacklist} },
 };
 
+decltype(ircd::net::acceptor::handshake_threads)
+ircd::net::acceptor::handshake_threads
+{
+	{ "name",     "ircd.net.acceptor.handshake.threads" },
+	{ "default",  2L                                    },
+	{ "description",
+
+	R"(
+	Number of threads conducting TLS handshakes for new connections; each
+	thread handles any number of handshakes asynchronously. Zero
+	conducts them asynchronously on the main thread instead. The number of
+	handshakes at once is still limited by ircd.net.acceptor.handshaking.max.
+	)"},
+};
+
+decltype(ircd::net::acceptor::handshake_latency)
+ircd::net::acceptor::handshake_latency
+{
+	{ "name", "ircd.net.acceptor.handshake.latency" },
+};
+
 //
 // acceptor::acceptor
 //
@@ -333,6 +391,7 @@ try
 	};
 
 	open();
+	++handshake_pool::acceptors;
 }
 catch(const boost::system::system_error &e)
 {
@@ -350,6 +409,10 @@ noexcept
 			accepting,
 			handshaking.size(),
 		};
+
+	assert(handshake_pool::acceptors > 0);
+	if(!--handshake_pool::acceptors)
+		handshake_pool::stop();
 }
 
 void
@@ -405,7 +468,17 @@ ircd::net::acceptor::close()
 		a.close();
 
 	for(const auto &sock : handshaking)
-		sock->cancel();
+	{
+		const auto it
+		{
+			handshake_pool::active.find(sock.get())
+		};
+
+		if(it != end(handshake_pool::active))
+			::shutdown(it->second, SHUT_RDWR);
+		else
+			sock->cancel();
+	}
 
 	join();
 	log::debug
@@ -571,15 +644,26 @@ noexcept try
 		handshaking.emplace(end(handshaking), sock)
 	};
 
+	const auto started
+	{
+		now<steady_point>()
+	};
+
+	assert(!openssl::get_app_data(*sock));
+	openssl::set_app_data(*sock, sock.get());
+	if(size_t(handshake_threads))
+	{
+		handshake_offload(sock, it, started);
+		return;
+	}
+
 	auto handshake
 	{
-		std::bind(&acceptor::handshake, this, ph::_1, sock, it)
+		std::bind(&acceptor::handshake, this, ph::_1, sock, it, started)
 	};
 
 	sock->set_timeout(milliseconds(timeout));
 	sock->ssl.async_handshake(handshake_type, ios::handle(desc, std::move(handshake)));
-	assert(!openssl::get_app_data(*sock));
-	openssl::set_app_data(*sock, sock.get());
 }
 catch(const ctx::interrupted &e)
 {
@@ -616,6 +700,93 @@ catch(const std::exception &e)
 	joining.notify_all();
 }
 
+/// Conducts the handshake on the handshake_pool. The result is posted back
+/// to the main thread for handshake() as usual.
+void
+ircd::net::acceptor::handshake_offload(const std::shared_ptr<socket> &sock,
+                                       const decltype(handshaking)::const_iterator it,
+                                       const steady_point &started)
+{
+	static ios::descriptor desc
+	{
+		"ircd::net::acceptor handshake_offload"
+	};
+
+	handshake_pool::start();
+
+	// Rebind the descriptor to the pool's io_context; the ssl stream refers
+	// to this same socket object so it follows.
+	ip::tcp::socket &sd(*sock);
+	const auto protocol
+	{
+		ep.protocol()
+	};
+
+	const int fd
+	{
+		sd.release()
+	};
+
+	sd = ip::tcp::socket{handshake_pool::context};
+	sd.assign(protocol, fd);
+
+	// The timer and the flag are only used on the main thread.
+	auto done
+	{
+		std::make_shared<bool>(false)
+	};
+
+	auto timer
+	{
+		std::make_shared<asio::steady_timer>(ios::get())
+	};
+
+	timer->expires_after(milliseconds(timeout));
+	timer->async_wait([done, fd]
+	(const error_code &ec)
+	{
+		if(!ec && !*done)
+			::shutdown(fd, SHUT_RDWR);
+	});
+
+	handshake_pool::active.emplace(sock.get(), fd);
+	const auto complete{[this, sock, it, started, done, timer, protocol]
+	(error_code ec)
+	{
+		// Release from the pool's reactor here; it's assigned back to the
+		// main io_context on the main thread.
+		error_code rec;
+		ip::tcp::socket &sd(*sock);
+		const int fd
+		{
+			sd.release(rec)
+		};
+
+		if(rec && !ec)
+			ec = rec;
+
+		ircd::post(desc, [this, sock, it, started, done, timer, protocol, ec, fd]
+		{
+			*done = true;
+			timer->cancel();
+			handshake_pool::active.erase(sock.get());
+
+			error_code aec;
+			ip::tcp::socket &sd(*sock);
+			sd = ip::tcp::socket{ios::get()};
+			if(fd >= 0)
+				sd.assign(protocol, fd, aec);
+
+			handshake(ec? ec: aec, sock, it, started);
+		});
+	}};
+
+	asio::post(handshake_pool::context, [sock, complete]
+	{
+		sock->ssl.async_handshake(socket::handshake_type::server, complete);
+	});
+}
+
 /// Error handler for the accept socket callback. This handler determines
 /// whether or not the handler should return or continue processing the
 /// result.
@@ -704,7 +875,8 @@ ircd::net::acceptor::proffer_default(listener &listener,
 void
 ircd::net::acceptor::handshake(const error_code &ec,
                                const std::shared_ptr<socket> sock,
-                               const decltype(handshaking)::const_iterator it)
+                               const decltype(handshaking)::const_iterator it,
+                               const steady_point &started)
 noexcept try
 {
 	assert(bool(sock));
@@ -739,6 +911,7 @@ noexcept try
 	openssl::set_app_data(*sock, nullptr);
 	check_handshake_error(ec, *sock);
 	sock->cancel_timeout();
+	handshake_latency(duration_cast<microseconds>(now<steady_point>() - started).count());
 	assert(bool(cb));
 
 	// Toggles the behavior of non-async functions; see func comment
@@ -1334,3 +1507,48 @@ ircd::net::acceptor::configure_password(const json::object &opts)
 		return "foobar";
 	});
 }
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// handshake_pool
+//
+
+void
+ircd::net::handshake_pool::start()
+{
+	if(!work)
+	{
+		context.restart();
+		work.emplace(context.get_executor());
+	}
+
+	while(threads.size() < size_t(acceptor::handshake_threads))
+		threads.emplace_back(&worker);
+}
+
+void
+ircd::net::handshake_pool::stop()
+noexcept
+{
+	assert(active.empty());
+	work.reset();
+	for(auto &thread : threads)
+		thread.join();
+
+	threads.clear();
+}
+
+void
+ircd::net::handshake_pool::worker()
+noexcept try
+{
+	context.run();
+}
+catch(const std::exception &e)
+{
+	log::critical
+	{
+		acceptor::log, "Handshake thread :%s",
+		e.what(),
+	};
+}
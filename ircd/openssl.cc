@@ -96,6 +96,92 @@ ircd::openssl::server_name(const SSL &ssl)
 	return ::SSL_get_servername(&ssl, type);
 }
 
+//
+// Session
+//
+
+/// Client-side session caching with external storage only; new sessions
+/// (including TLS 1.3 tickets arriving after the handshake) are given to
+/// the callback, which does not take ownership (returns 0).
+void
+ircd::openssl::set_session_cache(SSL_CTX &ctx,
+                                 new_session_cb cb)
+{
+	SSL_CTX_set_session_cache_mode(&ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(&ctx, cb);
+}
+
+/// Offer a serialized session for resumption on the next handshake. Returns
+/// false if the session can't be used.
+bool
+ircd::openssl::set_session(SSL &ssl,
+                           const const_buffer &buf)
+{
+	const auto *ptr
+	{
+		reinterpret_cast<const uint8_t *>(data(buf))
+	};
+
+	SSL_SESSION *const sess
+	{
+		d2i_SSL_SESSION(nullptr, &ptr, size(buf))
+	};
+
+	if(!sess)
+		return false;
+
+	const unwind free{[&sess]
+	{
+		SSL_SESSION_free(sess);
+	}};
+
+	#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+	if(!SSL_SESSION_is_resumable(sess))
+		return false;
+	#endif
+
+	return SSL_set_session(&ssl, sess) == 1;
+}
+
+ircd::string_view
+ircd::openssl::get_session(const mutable_buffer &buf,
+                           const SSL_SESSION &sess)
+{
+	auto *const s
+	{
+		const_cast<SSL_SESSION *>(&sess)
+	};
+
+	const int len
+	{
+		i2d_SSL_SESSION(s, nullptr)
+	};
+
+	if(len <= 0 || size_t(len) > size(buf))
+		return {};
+
+	auto *ptr
+	{
+		reinterpret_cast<uint8_t *>(data(buf))
+	};
+
+	const int ret
+	{
+		i2d_SSL_SESSION(s, &ptr)
+	};
+
+	return string_view
+	{
+		data(buf), size_t(std::max(ret, 0))
+	};
+}
+
+bool
+ircd::openssl::session_reused(const SSL &ssl)
+{
+	return SSL_session_reused(const_cast<SSL *>(&ssl));
+}
+
 //
 // Cipher suite
 //
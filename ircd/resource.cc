@@ -349,6 +349,42 @@ ircd::resource::method::default_payload_max
 	{ "default", long(128_KiB)                              },
 };
 
+//
+// method::stats
+//
+
+/// The latency histogram is registered as
+/// ircd.resource.<path>.<METHOD>.latency; the path is flattened into the
+/// dotted namespace. It is omitted if the name is already taken.
+ircd::resource::method::stats::stats(const method &method)
+{
+	char buf[ircd::stats::NAME_MAX_LEN + 1];
+	mutable_buffer out{buf, ircd::stats::NAME_MAX_LEN};
+	consume(out, copy(out, "ircd.resource"_sv));
+	for(const char &c : method.resource->path)
+		if(!empty(out))
+			consume(out, copy(out, c == '/'? '.' : std::isalnum(c)? c : '_'));
+
+	if(!endswith(string_view{buf, data(out)}, '.'))
+		consume(out, copy(out, '.'));
+
+	consume(out, copy(out, method.name));
+	consume(out, copy(out, ".latency"_sv));
+	const string_view name
+	{
+		buf, data(out)
+	};
+
+	if(ircd::stats::items.count(name))
+		return;
+
+	latency = std::make_unique<histogram>(json::members
+	{
+		{ "name", name },
+		{ "desc", "Microseconds spent in the handler" },
+	});
+}
+
 //
 // method::method
 //
@@ -385,7 +421,7 @@ ircd::resource::method::method(struct resource &resource,
 }
 ,stats
 {
-	std::make_unique<struct stats>()
+	std::make_unique<struct stats>(*this)
 }
 ,methods_it{[this, &name]
 {
@@ -447,6 +483,12 @@ try
 		stats->pending
 	};
 
+	const unwind latency{[this, started(now<steady_point>())]
+	{
+		if(likely(stats->latency))
+			(*stats->latency)(duration_cast<microseconds>(now<steady_point>() - started).count());
+	}};
+
 	// Bail out if the method limited the amount of content and it was exceeded.
 	if(!content_length_acceptable(head))
 		throw http::error
@@ -1183,7 +1225,7 @@ ircd::resource::response::response(client &client,
 	log::logf
 	{
 		log, level,
-		"%s HTTP %u `%s' %s in %s; %s content-length:%s wrote:%zu %s%s",
+		"%s HTTP %u `%s' %s in %s; %s content-length:%s wrote:%zu %s%s"_fmt,
 		client.loghead(),
 		uint(code),
 		client.request.head.path,
@@ -533,7 +533,7 @@ ircd::server::loghead(const mutable_buffer &buf,
 {
 	return fmt::sprintf
 	{
-		buf, "%s %s",
+		buf, "%s %s"_fmt,
 		loghead(link),
 		loghead(request)
 	};
@@ -567,7 +567,7 @@ try
 
 	return fmt::sprintf
 	{
-		buf, "tag:%lu %s %s",
+		buf, "tag:%lu %s %s"_fmt,
 		id(request),
 		head.method,
 		head.path
@@ -688,6 +688,20 @@ ircd::server::peer::link_max_default
 	{ "default",  4L                          }
 };
 
+decltype(ircd::server::peer::session_resumption)
+ircd::server::peer::session_resumption
+{
+	{ "name",     "ircd.server.peer.session_resumption" },
+	{ "default",  true                                  },
+	{ "description",
+
+	R"(
+	Resume the TLS session of a previous connection when a link to the same
+	peer is opened again. The session is shared by all links of the peer and
+	kept for the life of the peer.
+	)"},
+};
+
 decltype(ircd::server::peer::ids)
 ircd::server::peer::ids;
 
@@ -729,6 +743,10 @@ ircd::server::peer::peer(const net::hostport &hostport,
 		};
 
 	this->open_opts.ipport = this->remote;
+
+	// Each peer keeps its own session; it is never offered to another host.
+	if(session_resumption)
+		this->open_opts.session = std::make_shared<std::string>();
 }
 
 ircd::server::peer::~peer()
@@ -1882,7 +1900,7 @@ ircd::server::loghead(const mutable_buffer &buf,
 
 	return fmt::sprintf
 	{
-		buf, "socket:%lu local:%s remote:%s link:%lu peer:%lu",
+		buf, "socket:%lu local:%s remote:%s link:%lu peer:%lu"_fmt,
 		link.socket?
 			link.socket->id : 0UL,
 		local?
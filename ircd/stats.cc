@@ -41,7 +41,7 @@ ircd::stats::string(const mutable_buffer &buf,
 		assert(item.val);
 		return fmt::sprintf
 		{
-			buf, "%lu", *item.val
+			buf, "%lu"_fmt, *item.val
 		};
 	}
 	else if(item_.type == typeid(uint32_t *))
@@ -54,7 +54,7 @@ ircd::stats::string(const mutable_buffer &buf,
 		assert(item.val);
 		return fmt::sprintf
 		{
-			buf, "%u", *item.val
+			buf, "%u"_fmt, *item.val
 		};
 	}
 	else if(item_.type == typeid(uint16_t *))
@@ -67,7 +67,26 @@ ircd::stats::string(const mutable_buffer &buf,
 		assert(item.val);
 		return fmt::sprintf
 		{
-			buf, "%u", *item.val
+			buf, "%u"_fmt, *item.val
+		};
+	}
+	else if(item_.type == typeid(histogram *))
+	{
+		const auto &item
+		{
+			dynamic_cast<const stats::item<histogram *> &>(item_)
+		};
+
+		assert(item.val);
+		const auto &hist(*item.val);
+		return fmt::sprintf
+		{
+			buf, "count:%lu sum:%lu p50:%lu p90:%lu p99:%lu"_fmt,
+			hist.count,
+			hist.sum,
+			hist.percentile(0.50),
+			hist.percentile(0.90),
+			hist.percentile(0.99),
 		};
 	}
 	else throw error
@@ -77,6 +96,44 @@ ircd::stats::string(const mutable_buffer &buf,
 	};
 }
 
+//
+// histogram
+//
+
+/// Estimate the value at the given quantile (0.0 to 1.0). The result is the
+/// upper bound of the bucket containing the quantile.
+uint64_t
+ircd::stats::histogram::percentile(const long double &p)
+const noexcept
+{
+	if(!count)
+		return 0;
+
+	const uint64_t rank
+	{
+		std::max(uint64_t(std::ceil(p * count)), 1UL)
+	};
+
+	uint64_t cumulative(0);
+	for(size_t i(0); i < BUCKETS; ++i)
+		if((cumulative += bucket[i]) >= rank)
+			return upper(i);
+
+	return upper(BUCKETS - 1);
+}
+
+/// Index of the highest non-empty bucket, or zero when empty.
+size_t
+ircd::stats::histogram::last()
+const noexcept
+{
+	for(size_t i(BUCKETS); i > 0; --i)
+		if(bucket[i - 1])
+			return i - 1;
+
+	return 0;
+}
+
 //
 // item
 //
@@ -210,6 +267,23 @@ ircd::stats::item<uint16_t *>::item(uint16_t *const &val,
 {
 }
 
+//
+// item<histogram *>
+//
+
+ircd::stats::item<ircd::stats::histogram *>::item(histogram *const &val,
+                                                 const json::members &feature)
+:item<void>
+{
+	typeid(histogram *), feature
+}
+,val
+{
+	val
+}
+{
+}
+
 //
 // value-carrying items
 //
@@ -261,3 +335,15 @@ ircd::stats::item<uint16_t>::item(const json::members &feature)
 }
 {
 }
+
+//
+// item<histogram>
+//
+
+ircd::stats::item<ircd::stats::histogram>::item(const json::members &feature)
+:item<histogram *>
+{
+	std::addressof(this->val), feature
+}
+{
+}
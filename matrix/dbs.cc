@@ -122,12 +122,16 @@ ircd::m::dbs::init::init(const string_view &servername,
 	event_sender = db::domain{*events, desc::event_sender.name};
 	event_type = db::domain{*events, desc::event_type.name};
 	event_state = db::domain{*events, desc::event_state.name};
+	event_auth_chain = db::column{*events, desc::event_auth_chain.name};
 	room_head = db::domain{*events, desc::room_head.name};
 	room_events = db::domain{*events, desc::room_events.name};
 	room_type = db::domain{*events, desc::room_type.name};
 	room_joined = db::domain{*events, desc::room_joined.name};
 	room_state = db::domain{*events, desc::room_state.name};
 	room_state_space = db::domain{*events, desc::room_state_space.name};
+	room_search = db::domain{*events, desc::room_search.name};
+	room_state_delta = db::domain{*events, desc::room_state_delta.name};
+	room_state_snapshot = db::domain{*events, desc::room_state_snapshot.name};
 }
 
 /// Shuts down the m::dbs subsystem; closes the events database. The extern
@@ -285,6 +289,9 @@ ircd::m::dbs::_index_event(db::txn &txn,
 
 	if(opts.appendix.test(appendix::EVENT_HORIZON_RESOLVE) && opts.horizon_resolve.any())
 		_index_event_horizon_resolve(txn, event, opts);
+
+	if(opts.appendix.test(appendix::EVENT_AUTH_CHAIN))
+		_index_event_auth_chain(txn, event, opts);
 }
 
 void
@@ -314,12 +321,18 @@ ircd::m::dbs::_index_room(db::txn &txn,
 		if(opts.appendix.test(appendix::ROOM_STATE_SPACE))
 			_index_room_state_space(txn, event, opts);
 
+		if(opts.appendix.test(appendix::ROOM_STATE_DELTA))
+			_index_room_state_delta(txn, event, opts);
+
 		if(opts.appendix.test(appendix::ROOM_JOINED) && at<"type"_>(event) == "m.room.member")
 			_index_room_joined(txn, event, opts);
 	}
 
 	if(opts.appendix.test(appendix::ROOM_REDACT) && json::get<"type"_>(event) == "m.room.redaction")
 		_index_room_redact(txn, event, opts);
+
+	if(opts.appendix.test(appendix::ROOM_SEARCH) && json::get<"content"_>(event))
+		_index_room_search(txn, event, opts);
 }
 
 // NOTE: QUERY
@@ -505,6 +505,10 @@ ircd::m::dbs::desc::events
 	// Mapping of event states, indexed for application features.
 	event_state,
 
+	// event_idx => [event_idx...]
+	// Materialized auth chain of events which can be auth_events.
+	event_auth_chain,
+
 	// (room_id, (depth, event_idx))
 	// Sequence of all events for a room, ever.
 	room_events,
@@ -529,6 +533,18 @@ ircd::m::dbs::desc::events
 	// Mapping of all current head events for a room.
 	room_head,
 
+	// (room_id, term) => (event_idx...)
+	// Full text index of events in a room.
+	room_search,
+
+	// (room_id, (depth, event_idx)) => (type, state_key)
+	// Sequence of state events of the room by depth.
+	room_state_delta,
+
+	// (room_id, depth) => (type, state_key, depth, event_idx)...
+	// Snapshots of the state of the room at some depth.
+	room_state_snapshot,
+
 	//
 	// These columns are legacy; they have been dropped from the schema.
 	//
@@ -0,0 +1,256 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+decltype(ircd::m::dbs::event_auth_chain)
+ircd::m::dbs::event_auth_chain;
+
+decltype(ircd::m::dbs::desc::event_auth_chain__comp)
+ircd::m::dbs::desc::event_auth_chain__comp
+{
+	{ "name",     "ircd.m.dbs._event_auth_chain.comp" },
+	{ "default",  "default"                           },
+};
+
+decltype(ircd::m::dbs::desc::event_auth_chain__block__size)
+ircd::m::dbs::desc::event_auth_chain__block__size
+{
+	{ "name",     "ircd.m.dbs._event_auth_chain.block.size" },
+	{ "default",  long(4_KiB)                               },
+};
+
+decltype(ircd::m::dbs::desc::event_auth_chain__meta_block__size)
+ircd::m::dbs::desc::event_auth_chain__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._event_auth_chain.meta_block.size" },
+	{ "default",  512L                                           },
+};
+
+decltype(ircd::m::dbs::desc::event_auth_chain__cache__size)
+ircd::m::dbs::desc::event_auth_chain__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._event_auth_chain.cache.size" },
+		{ "default",  long(32_MiB)                              },
+	}, []
+	{
+		const size_t &value{event_auth_chain__cache__size};
+		db::capacity(db::cache(dbs::event_auth_chain), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::event_auth_chain__cache_comp__size)
+ircd::m::dbs::desc::event_auth_chain__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._event_auth_chain.cache_comp.size" },
+		{ "default",  long(0_MiB)                                    },
+	}, []
+	{
+		const size_t &value{event_auth_chain__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::event_auth_chain), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::event_auth_chain__bloom__bits)
+ircd::m::dbs::desc::event_auth_chain__bloom__bits
+{
+	{ "name",     "ircd.m.dbs._event_auth_chain.bloom.bits" },
+	{ "default",  10L                                       },
+};
+
+/// The value is the event_idx of each of the auth_events of the event, as a
+/// sorted array. It is written for the types which can be auth_events of
+/// another event, so the auth chain is traversed over this column without
+/// fetching and resolving the auth_events of each event on the way.
+///
+const ircd::db::descriptor
+ircd::m::dbs::desc::event_auth_chain
+{
+	// name
+	"_event_auth_chain",
+
+	// explanation
+	R"(Auth event links of events which can be auth_events.
+
+	event_idx => [event_idx...]
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(uint64_t), typeid(string_view)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	{},
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0, //uses conf item
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	size_t(event_auth_chain__bloom__bits),
+
+	// expect queries hit
+	false,
+
+	// block size
+	size_t(event_auth_chain__block__size),
+
+	// meta_block size
+	size_t(event_auth_chain__meta_block__size),
+
+	// compression
+	string_view{event_auth_chain__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
+//
+// indexer
+//
+
+/// Only the links to the auth_events are stored; the chain itself is their
+/// closure which readers traverse. Nothing is written when any auth_event is
+/// not yet resolvable from the database or the interposed txn; readers then
+/// resolve the auth_events of that event themselves.
+// NOTE: QUERY
+void
+ircd::m::dbs::_index_event_auth_chain(db::txn &txn,
+                                      const event &event,
+                                      const write_opts &opts)
+{
+	assert(opts.appendix.test(appendix::EVENT_AUTH_CHAIN));
+	assert(opts.event_idx);
+
+	if(!event_auth_chain_type(json::get<"type"_>(event)))
+		return;
+
+	const string_view &key
+	{
+		byte_view<string_view>(opts.event_idx)
+	};
+
+	if(opts.op == db::op::DELETE)
+	{
+		db::txn::append
+		{
+			txn, event_auth_chain,
+			{
+				opts.op,   // db::op
+				key,       // key
+			}
+		};
+
+		return;
+	}
+
+	if(opts.op != db::op::SET || !opts.allow_queries)
+		return;
+
+	const event::prev prev
+	{
+		event
+	};
+
+	const size_t count
+	{
+		std::min(prev.auth_events_count(), event::prev::MAX)
+	};
+
+	event::id auth_id[count];
+	event::idx auth_idx[count];
+	for(size_t i(0); i < count; ++i)
+		auth_id[i] = prev.auth_event(i);
+
+	const auto found
+	{
+		find_event_idx({auth_idx, count}, {auth_id, count}, opts)
+	};
+
+	if(found < count)
+		return;
+
+	std::sort(auth_idx, auth_idx + count);
+	const string_view val
+	{
+		reinterpret_cast<const char *>(auth_idx),
+		size_t(std::distance(auth_idx, std::unique(auth_idx, auth_idx + count)))
+		* sizeof(event::idx)
+	};
+
+	db::txn::append
+	{
+		txn, event_auth_chain,
+		{
+			opts.op,   // db::op
+			key,       // key
+			val,       // val
+		}
+	};
+}
+
+//
+// query
+//
+
+bool
+ircd::m::dbs::find_event_auth_chain(const event::idx &event_idx,
+                                    const event_auth_chain_closure &closure)
+{
+	const byte_view<string_view> key
+	{
+		event_idx
+	};
+
+	return event_auth_chain(key, std::nothrow, [&closure]
+	(const string_view &val)
+	{
+		// The value carries no alignment; copy it out.
+		event::idx auth_idx[event::prev::MAX];
+		const size_t count
+		{
+			std::min(size(val) / sizeof(event::idx), event::prev::MAX)
+		};
+
+		memcpy(auth_idx, data(val), count * sizeof(event::idx));
+		closure(vector_view<const event::idx>
+		{
+			auth_idx, count
+		});
+	});
+}
+
+bool
+ircd::m::dbs::event_auth_chain_type(const string_view &type)
+{
+	return false
+	|| type == "m.room.create"
+	|| type == "m.room.power_levels"
+	|| type == "m.room.join_rules"
+	|| type == "m.room.member"
+	|| type == "m.room.third_party_invite"
+	;
+}
@@ -0,0 +1,474 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+namespace ircd::m::dbs
+{
+	static std::string room_search__merge(const string_view &, const db::merge_delta &);
+
+	constexpr size_t ROOM_SEARCH_TERMS_MAX {512};
+}
+
+decltype(ircd::m::dbs::room_search)
+ircd::m::dbs::room_search;
+
+decltype(ircd::m::dbs::desc::room_search__terms__max)
+ircd::m::dbs::desc::room_search__terms__max
+{
+	{ "name",     "ircd.m.dbs._room_search.terms.max" },
+	{ "default",  256L                                },
+	{ "description",
+
+	R"(
+	Maximum number of distinct terms indexed for a single event. Terms past
+	this limit are not searchable. Hard limit of 512.
+	)"},
+};
+
+decltype(ircd::m::dbs::desc::room_search__comp)
+ircd::m::dbs::desc::room_search__comp
+{
+	{ "name",     "ircd.m.dbs._room_search.comp" },
+	{ "default",  "default"                      },
+};
+
+decltype(ircd::m::dbs::desc::room_search__block__size)
+ircd::m::dbs::desc::room_search__block__size
+{
+	{ "name",     "ircd.m.dbs._room_search.block.size" },
+	{ "default",  4096L                                },
+};
+
+decltype(ircd::m::dbs::desc::room_search__meta_block__size)
+ircd::m::dbs::desc::room_search__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._room_search.meta_block.size" },
+	{ "default",  4096L                                     },
+};
+
+decltype(ircd::m::dbs::desc::room_search__cache__size)
+ircd::m::dbs::desc::room_search__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_search.cache.size" },
+		{ "default",  long(16_MiB)                         },
+	}, []
+	{
+		const size_t &value{room_search__cache__size};
+		db::capacity(db::cache(dbs::room_search), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::room_search__cache_comp__size)
+ircd::m::dbs::desc::room_search__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_search.cache_comp.size" },
+		{ "default",  long(0_MiB)                               },
+	}, []
+	{
+		const size_t &value{room_search__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::room_search), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::room_search__bloom__bits)
+ircd::m::dbs::desc::room_search__bloom__bits
+{
+	{ "name",     "ircd.m.dbs._room_search.bloom.bits" },
+	{ "default",  10L                                  },
+};
+
+/// Prefix transform for the room_search. The prefix here is a room_id
+/// and the suffix is the term.
+///
+const ircd::db::prefix_transform
+ircd::m::dbs::desc::room_search__pfx
+{
+	"_room_search",
+
+	[](const string_view &key)
+	{
+		return has(key, "\0"_sv);
+	},
+
+	[](const string_view &key)
+	{
+		return split(key, '\0').first;
+	}
+};
+
+/// This column is an inverted index of the searchable content of events in
+/// a room. The value is the list of event_idx containing the term, sorted
+/// and delta-encoded with uleb128. New events are added with op::MERGE
+/// so the indexer never reads the existing list.
+///
+/// [room_id | term] => [event_idx...]
+///
+/// Entries are never removed; queries must confirm the candidate event still
+/// contains the terms (i.e. it may have been redacted).
+///
+/// Only events written after this column was added are indexed; rooms with
+/// prior history are indexed with the console command `room search rebuild`.
+///
+const ircd::db::descriptor
+ircd::m::dbs::desc::room_search
+{
+	// name
+	"_room_search",
+
+	// explanation
+	R"(Full text index of the content of events in a room.
+
+	[room_id | term] => [event_idx...]
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(string_view), typeid(string_view)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	room_search__pfx,
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0,
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	size_t(room_search__bloom__bits),
+
+	// expect queries hit
+	false,
+
+	// block size
+	size_t(room_search__block__size),
+
+	// meta_block size
+	size_t(room_search__meta_block__size),
+
+	// compression
+	string_view{room_search__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+
+	// target_file_size
+	{
+		64_MiB,  // base
+		2L,      // multiplier
+	},
+
+	// max_bytes_for_level
+	{
+		{  32_MiB,   1L }, // max_bytes_for_level_base
+		{      0L,   0L }, // max_bytes_for_level[0]
+		{      0L,   1L }, // max_bytes_for_level[1]
+		{      0L,   1L }, // max_bytes_for_level[2]
+		{      0L,   3L }, // max_bytes_for_level[3]
+		{      0L,   7L }, // max_bytes_for_level[4]
+		{      0L,  15L }, // max_bytes_for_level[5]
+		{      0L,  31L }, // max_bytes_for_level[6]
+	},
+
+	// compaction_period
+	60s * 60 * 24 * 21,
+
+	// write_buffer_blocks
+	8192,
+
+	// merge operator
+	room_search__merge,
+};
+
+//
+// indexer
+//
+
+/// Adds a posting for each term of the content.body, content.name and
+/// content.topic of the event.
+void
+ircd::m::dbs::_index_room_search(db::txn &txn,
+                                 const event &event,
+                                 const write_opts &opts)
+{
+	assert(opts.appendix.test(appendix::ROOM_SEARCH));
+
+	// Postings are only ever appended; see the descriptor.
+	if(opts.op != db::op::SET)
+		return;
+
+	const json::object &content
+	{
+		json::get<"content"_>(event)
+	};
+
+	static const string_view keys[]
+	{
+		"body", "name", "topic"
+	};
+
+	const size_t terms_max
+	{
+		std::min(size_t(desc::room_search__terms__max), ROOM_SEARCH_TERMS_MAX)
+	};
+
+	const ctx::critical_assertion ca;
+	thread_local char text_buf[event::MAX_SIZE];
+	thread_local char term_buf[ROOM_SEARCH_TERMS_MAX][ROOM_SEARCH_TERM_MAX_SIZE];
+	thread_local string_view terms[ROOM_SEARCH_TERMS_MAX];
+	size_t terms_count(0);
+	for(const auto &key : keys)
+	{
+		const json::string &value
+		{
+			content.get(key)
+		};
+
+		if(!value || terms_count >= terms_max)
+			continue;
+
+		const string_view text
+		{
+			json::unescape(text_buf, value)
+		};
+
+		room_search_terms(text, [&](const string_view &term)
+		{
+			terms[terms_count] = string_view
+			{
+				term_buf[terms_count], copy(term_buf[terms_count], term)
+			};
+
+			return ++terms_count < terms_max;
+		});
+	}
+
+	std::sort(terms, terms + terms_count);
+	terms_count = std::distance(terms, std::unique(terms, terms + terms_count));
+
+	char postings_buf[16];
+	const string_view postings
+	{
+		room_search_postings(postings_buf, vector_view<const event::idx>
+		{
+			&opts.event_idx, 1
+		})
+	};
+
+	thread_local char key_buf[ROOM_SEARCH_KEY_MAX_SIZE];
+	for(size_t i(0); i < terms_count; ++i)
+	{
+		const string_view &key
+		{
+			room_search_key(key_buf, at<"room_id"_>(event), terms[i])
+		};
+
+		db::txn::append
+		{
+			txn, room_search,
+			{
+				db::op::MERGE,  // db::op
+				key,            // key
+				postings,       // val
+			}
+		};
+	}
+}
+
+//
+// merge
+//
+
+std::string
+ircd::m::dbs::room_search__merge(const string_view &key,
+                                 const db::merge_delta &delta)
+{
+	std::vector<event::idx> a, b;
+	room_search_postings(delta.first, [&a](const event::idx &idx)
+	{
+		a.emplace_back(idx);
+		return true;
+	});
+
+	room_search_postings(delta.second, [&b](const event::idx &idx)
+	{
+		b.emplace_back(idx);
+		return true;
+	});
+
+	std::vector<event::idx> c;
+	c.reserve(a.size() + b.size());
+	std::set_union(begin(a), end(a), begin(b), end(b), std::back_inserter(c));
+
+	std::string ret(c.size() * sizeof(uint64_t), char{});
+	const auto postings
+	{
+		room_search_postings(mutable_buffer{ret}, c)
+	};
+
+	ret.resize(size(postings));
+	return ret;
+}
+
+//
+// postings
+//
+
+ircd::string_view
+ircd::m::dbs::room_search_postings(const mutable_buffer &out_,
+                                   const vector_view<const event::idx> &idx)
+{
+	mutable_buffer out{out_};
+	event::idx last(0);
+	for(const auto &i : idx)
+	{
+		assert(i > last || (!last && i));
+		assert(i - last < (1UL << 56));
+		const uint64_t enc
+		{
+			uleb128::encode(uint64_t(i - last))
+		};
+
+		const size_t len
+		{
+			uleb128::length(enc)
+		};
+
+		if(unlikely(size(out) < len))
+			break;
+
+		consume(out, copy(out, const_buffer{reinterpret_cast<const char *>(&enc), len}));
+		last = i;
+	}
+
+	return { data(out_), data(out) };
+}
+
+bool
+ircd::m::dbs::room_search_postings(const string_view &val,
+                                   const room_search_postings_closure &closure)
+{
+	event::idx last(0);
+	for(size_t i(0); i < size(val);)
+	{
+		uint64_t enc(0);
+		memcpy(&enc, data(val) + i, std::min(size(val) - i, sizeof(enc)));
+		const size_t len
+		{
+			uleb128::length(enc)
+		};
+
+		// The next delta follows; decode() doesn't stop at the terminating
+		// byte on its own.
+		if(len < sizeof(enc))
+			enc &= (1UL << (len * 8)) - 1;
+
+		i += len;
+		last += uleb128::decode(enc);
+		if(!closure(last))
+			return false;
+	}
+
+	return true;
+}
+
+//
+// terms
+//
+
+/// Terms are runs of ASCII alphanumerics or of any non-ASCII (UTF-8) bytes;
+/// ASCII is folded to lower case. Single characters are not terms and long
+/// terms are truncated to ROOM_SEARCH_TERM_MAX_SIZE at a character boundary.
+bool
+ircd::m::dbs::room_search_terms(const string_view &text,
+                                const room_search_term_closure &closure)
+{
+	const auto is_term_char{[](const char &c)
+	{
+		return uint8_t(c) >= 0x80 || std::isalnum(uint8_t(c));
+	}};
+
+	char buf[ROOM_SEARCH_TERM_MAX_SIZE];
+	for(auto it(begin(text)); it != end(text);)
+	{
+		it = std::find_if(it, end(text), is_term_char);
+		const auto stop
+		{
+			std::find_if_not(it, end(text), is_term_char)
+		};
+
+		size_t len
+		{
+			std::min(size_t(std::distance(it, stop)), sizeof(buf))
+		};
+
+		// Don't cut a truncated term in the middle of a UTF-8 sequence.
+		if(it + len != stop)
+			while(len && (uint8_t(it[len]) & 0xC0) == 0x80)
+				--len;
+
+		std::transform(it, it + len, buf, [](const char &c)
+		{
+			return uint8_t(c) < 0x80? char(std::tolower(c)): c;
+		});
+
+		it = stop;
+		if(len < 2)
+			continue;
+
+		if(!closure(string_view{buf, len}))
+			return false;
+	}
+
+	return true;
+}
+
+//
+// key
+//
+
+ircd::string_view
+ircd::m::dbs::room_search_key(const string_view &amalgam)
+{
+	const auto &[room_id, term]
+	{
+		split(amalgam, '\0')
+	};
+
+	return term;
+}
+
+ircd::string_view
+ircd::m::dbs::room_search_key(const mutable_buffer &out_,
+                              const id::room &room_id,
+                              const string_view &term)
+{
+	assert(room_id);
+	mutable_buffer out{out_};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, trunc(term, ROOM_SEARCH_TERM_MAX_SIZE)));
+	return { data(out_), data(out) };
+}
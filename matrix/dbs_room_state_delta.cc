@@ -0,0 +1,266 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+decltype(ircd::m::dbs::room_state_delta)
+ircd::m::dbs::room_state_delta;
+
+decltype(ircd::m::dbs::desc::room_state_delta__comp)
+ircd::m::dbs::desc::room_state_delta__comp
+{
+	{ "name",     "ircd.m.dbs._room_state_delta.comp" },
+	{ "default",  "default"                           },
+};
+
+decltype(ircd::m::dbs::desc::room_state_delta__block__size)
+ircd::m::dbs::desc::room_state_delta__block__size
+{
+	{ "name",     "ircd.m.dbs._room_state_delta.block.size" },
+	{ "default",  512L                                      },
+};
+
+decltype(ircd::m::dbs::desc::room_state_delta__meta_block__size)
+ircd::m::dbs::desc::room_state_delta__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._room_state_delta.meta_block.size" },
+	{ "default",  4096L                                          },
+};
+
+decltype(ircd::m::dbs::desc::room_state_delta__cache__size)
+ircd::m::dbs::desc::room_state_delta__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_state_delta.cache.size" },
+		{ "default",  long(16_MiB)                              },
+	}, []
+	{
+		const size_t &value{room_state_delta__cache__size};
+		db::capacity(db::cache(dbs::room_state_delta), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::room_state_delta__cache_comp__size)
+ircd::m::dbs::desc::room_state_delta__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_state_delta.cache_comp.size" },
+		{ "default",  long(0_MiB)                                    },
+	}, []
+	{
+		const size_t &value{room_state_delta__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::room_state_delta), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::room_state_delta__bloom__bits)
+ircd::m::dbs::desc::room_state_delta__bloom__bits
+{
+	{ "name",     "ircd.m.dbs._room_state_delta.bloom.bits" },
+	{ "default",  0L                                        },
+};
+
+/// Prefix transform for the room_state_delta. The prefix here is a room_id
+/// and the suffix is the big-endian depth and event_idx.
+///
+const ircd::db::prefix_transform
+ircd::m::dbs::desc::room_state_delta__pfx
+{
+	"_room_state_delta",
+
+	[](const string_view &key)
+	{
+		return has(key, "\0"_sv);
+	},
+
+	[](const string_view &key)
+	{
+		return split(key, '\0').first;
+	}
+};
+
+/// The state events of a room in the order of their depth; each is the
+/// change it makes to the state of the room. The integers in the key are
+/// big-endian so the default comparator orders them. The state at a depth
+/// is reconstructed from the nearest room_state_snapshot below it with the
+/// deltas from there.
+///
+/// [room_id | depth, event_idx] => [type | state_key]
+///
+const ircd::db::descriptor
+ircd::m::dbs::desc::room_state_delta
+{
+	// name
+	"_room_state_delta",
+
+	// explanation
+	R"(State events of a room by depth.
+
+	[room_id | depth, event_idx] => [type | state_key]
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(string_view), typeid(string_view)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	room_state_delta__pfx,
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0,
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	size_t(room_state_delta__bloom__bits),
+
+	// expect queries hit
+	true,
+
+	// block size
+	size_t(room_state_delta__block__size),
+
+	// meta_block size
+	size_t(room_state_delta__meta_block__size),
+
+	// compression
+	string_view{room_state_delta__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
+//
+// indexer
+//
+
+/// Adds the delta of a state event. Snapshots of the room at a greater
+/// depth no longer reflect the state there and are removed.
+// NOTE: QUERY
+void
+ircd::m::dbs::_index_room_state_delta(db::txn &txn,
+                                      const event &event,
+                                      const write_opts &opts)
+{
+	assert(opts.appendix.test(appendix::ROOM_STATE_DELTA));
+	assert(opts.event_idx);
+	assert(defined(json::get<"state_key"_>(event)));
+
+	char key_buf[ROOM_STATE_DELTA_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		room_state_delta_key(key_buf, at<"room_id"_>(event), at<"depth"_>(event), opts.event_idx)
+	};
+
+	char val_buf[ROOM_STATE_DELTA_VAL_MAX_SIZE];
+	const string_view &val
+	{
+		opts.op == db::op::SET?
+			room_state_delta_val(val_buf, at<"type"_>(event), at<"state_key"_>(event)):
+			string_view{}
+	};
+
+	db::txn::append
+	{
+		txn, room_state_delta,
+		{
+			opts.op,   // db::op
+			key,       // key
+			val,       // val
+		}
+	};
+
+	// The snapshots are only taken where queries are allowed.
+	if(opts.allow_queries)
+		room_state_snapshot_invalidate(txn, at<"room_id"_>(event), at<"depth"_>(event));
+}
+
+//
+// key
+//
+
+ircd::string_view
+ircd::m::dbs::room_state_delta_key(const mutable_buffer &out_,
+                                   const id::room &room_id,
+                                   const int64_t &depth,
+                                   const event::idx &event_idx)
+{
+	assert(room_id);
+	const uint64_t val[2]
+	{
+		hton(uint64_t(depth)),
+		hton(uint64_t(event_idx)),
+	};
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, const_buffer{reinterpret_cast<const char *>(val), sizeof(val)}));
+	return { data(out_), data(out) };
+}
+
+std::tuple<int64_t, ircd::m::event::idx>
+ircd::m::dbs::room_state_delta_key(const string_view &amalgam)
+{
+	assert(size(amalgam) >= 16);
+	const string_view &val
+	{
+		amalgam.substr(size(amalgam) - 16)
+	};
+
+	return
+	{
+		int64_t(ntoh(uint64_t(byte_view<uint64_t>(val.substr(0, 8))))),
+		event::idx(ntoh(uint64_t(byte_view<uint64_t>(val.substr(8, 8))))),
+	};
+}
+
+//
+// val
+//
+
+ircd::string_view
+ircd::m::dbs::room_state_delta_val(const mutable_buffer &out_,
+                                   const string_view &type,
+                                   const string_view &state_key)
+{
+	mutable_buffer out{out_};
+	consume(out, copy(out, trunc(type, event::TYPE_MAX_SIZE)));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, trunc(state_key, event::STATE_KEY_MAX_SIZE)));
+	return { data(out_), data(out) };
+}
+
+std::tuple<ircd::string_view, ircd::string_view>
+ircd::m::dbs::room_state_delta_val(const string_view &val)
+{
+	const auto &[type, state_key]
+	{
+		split(val, '\0')
+	};
+
+	return
+	{
+		type, state_key
+	};
+}
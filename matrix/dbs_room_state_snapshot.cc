@@ -0,0 +1,362 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+namespace ircd::m::dbs
+{
+	static void room_state_snapshot_put(std::string &, const uint64_t &);
+	static uint64_t room_state_snapshot_get(const string_view &, size_t &);
+}
+
+decltype(ircd::m::dbs::room_state_snapshot)
+ircd::m::dbs::room_state_snapshot;
+
+decltype(ircd::m::dbs::desc::room_state_snapshot__comp)
+ircd::m::dbs::desc::room_state_snapshot__comp
+{
+	{ "name",     "ircd.m.dbs._room_state_snapshot.comp" },
+	{ "default",  "default"                              },
+};
+
+decltype(ircd::m::dbs::desc::room_state_snapshot__block__size)
+ircd::m::dbs::desc::room_state_snapshot__block__size
+{
+	{ "name",     "ircd.m.dbs._room_state_snapshot.block.size" },
+	{ "default",  long(64_KiB)                                 },
+};
+
+decltype(ircd::m::dbs::desc::room_state_snapshot__meta_block__size)
+ircd::m::dbs::desc::room_state_snapshot__meta_block__size
+{
+	{ "name",     "ircd.m.dbs._room_state_snapshot.meta_block.size" },
+	{ "default",  4096L                                             },
+};
+
+decltype(ircd::m::dbs::desc::room_state_snapshot__cache__size)
+ircd::m::dbs::desc::room_state_snapshot__cache__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_state_snapshot.cache.size" },
+		{ "default",  long(16_MiB)                                 },
+	}, []
+	{
+		const size_t &value{room_state_snapshot__cache__size};
+		db::capacity(db::cache(dbs::room_state_snapshot), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::room_state_snapshot__cache_comp__size)
+ircd::m::dbs::desc::room_state_snapshot__cache_comp__size
+{
+	{
+		{ "name",     "ircd.m.dbs._room_state_snapshot.cache_comp.size" },
+		{ "default",  long(0_MiB)                                       },
+	}, []
+	{
+		const size_t &value{room_state_snapshot__cache_comp__size};
+		db::capacity(db::cache_compressed(dbs::room_state_snapshot), value);
+	}
+};
+
+decltype(ircd::m::dbs::desc::room_state_snapshot__bloom__bits)
+ircd::m::dbs::desc::room_state_snapshot__bloom__bits
+{
+	{ "name",     "ircd.m.dbs._room_state_snapshot.bloom.bits" },
+	{ "default",  10L                                          },
+};
+
+/// Prefix transform for the room_state_snapshot. The prefix here is a
+/// room_id and the suffix is the inverted big-endian depth.
+///
+const ircd::db::prefix_transform
+ircd::m::dbs::desc::room_state_snapshot__pfx
+{
+	"_room_state_snapshot",
+
+	[](const string_view &key)
+	{
+		return has(key, "\0"_sv);
+	},
+
+	[](const string_view &key)
+	{
+		return split(key, '\0').first;
+	}
+};
+
+/// The state of a room below some depth: every (type, state_key) with the
+/// depth and event_idx of the latest state event below the depth. These are
+/// stored as the state is reconstructed by room::state::history and are
+/// removed when a state event arrives beneath them.
+///
+/// A snapshot is either a keyframe holding every cell, or the cells which
+/// differ from an earlier keyframe; the keyframe is shared by the snapshots
+/// which follow it. Cells are sorted and the keys front-coded against the
+/// previous cell, with the integers in uleb128. The depth in the key is
+/// inverted so the first snapshot found seeking a depth is the nearest at
+/// or below it.
+///
+/// [room_id | ~depth] => [base, (type | state_key, depth, event_idx)...]
+///
+const ircd::db::descriptor
+ircd::m::dbs::desc::room_state_snapshot
+{
+	// name
+	"_room_state_snapshot",
+
+	// explanation
+	R"(Snapshots of the state of a room at some depth.
+
+	[room_id | ~depth] => [base, (type | state_key, depth, event_idx)...]
+
+	)",
+
+	// typing (key, value)
+	{
+		typeid(string_view), typeid(string_view)
+	},
+
+	// options
+	{},
+
+	// comparator
+	{},
+
+	// prefix transform
+	room_state_snapshot__pfx,
+
+	// drop column
+	false,
+
+	// cache size
+	bool(cache_enable)? -1 : 0,
+
+	// cache size for compressed assets
+	bool(cache_comp_enable)? -1 : 0,
+
+	// bloom filter bits
+	size_t(room_state_snapshot__bloom__bits),
+
+	// expect queries hit
+	false,
+
+	// block size
+	size_t(room_state_snapshot__block__size),
+
+	// meta_block size
+	size_t(room_state_snapshot__meta_block__size),
+
+	// compression
+	string_view{room_state_snapshot__comp},
+
+	// compactor
+	{},
+
+	// compaction priority algorithm
+	"kOldestSmallestSeqFirst"s,
+};
+
+//
+// invalidate
+//
+
+// NOTE: QUERY
+size_t
+ircd::m::dbs::room_state_snapshot_invalidate(db::txn &txn,
+                                             const id::room &room_id,
+                                             const int64_t &depth)
+{
+	char buf[ROOM_STATE_SNAPSHOT_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		room_state_snapshot_key(buf, room_id, std::numeric_limits<int64_t>::max())
+	};
+
+	size_t ret(0);
+	for(auto it(room_state_snapshot.begin(key)); it; ++it, ++ret)
+	{
+		const int64_t snapshot_depth
+		{
+			room_state_snapshot_key(it->first)
+		};
+
+		if(snapshot_depth <= depth)
+			break;
+
+		char del_buf[ROOM_STATE_SNAPSHOT_KEY_MAX_SIZE];
+		db::txn::append
+		{
+			txn, room_state_snapshot,
+			{
+				db::op::DELETE,
+				room_state_snapshot_key(del_buf, room_id, snapshot_depth),
+			}
+		};
+	}
+
+	return ret;
+}
+
+//
+// cells
+//
+
+std::string
+ircd::m::dbs::room_state_snapshot_cells(const int64_t &base,
+                                        const vector_view<const room_state_snapshot_cell> &cells)
+{
+	std::string ret;
+	ret.reserve(8 + cells.size() * 24);
+	room_state_snapshot_put(ret, uint64_t(base + 1));
+
+	char last_buf[ROOM_STATE_DELTA_VAL_MAX_SIZE];
+	string_view last;
+	for(const auto &[type, state_key, depth, event_idx] : cells)
+	{
+		char key_buf[ROOM_STATE_DELTA_VAL_MAX_SIZE];
+		const string_view &key
+		{
+			room_state_delta_val(key_buf, type, state_key)
+		};
+
+		assert(!last || last < key);
+		const auto shared
+		{
+			std::mismatch(begin(last), end(last), begin(key), end(key)).first - begin(last)
+		};
+
+		room_state_snapshot_put(ret, shared);
+		room_state_snapshot_put(ret, size(key) - shared);
+		ret.append(data(key) + shared, size(key) - shared);
+		room_state_snapshot_put(ret, uint64_t(depth));
+		room_state_snapshot_put(ret, event_idx);
+		last = { last_buf, copy(last_buf, key) };
+	}
+
+	return ret;
+}
+
+bool
+ircd::m::dbs::room_state_snapshot_cells(const string_view &val,
+                                        const room_state_snapshot_closure &closure)
+{
+	size_t pos(0);
+	room_state_snapshot_get(val, pos); // base
+
+	char key_buf[ROOM_STATE_DELTA_VAL_MAX_SIZE];
+	size_t key_len(0);
+	while(pos < size(val))
+	{
+		const size_t shared(room_state_snapshot_get(val, pos));
+		const size_t suffix(room_state_snapshot_get(val, pos));
+		if(unlikely(shared > key_len || shared + suffix > sizeof(key_buf) || pos + suffix > size(val)))
+			throw panic
+			{
+				"Malformed state snapshot cell at offset %zu of %zu",
+				pos,
+				size(val),
+			};
+
+		memcpy(key_buf + shared, data(val) + pos, suffix);
+		key_len = shared + suffix;
+		pos += suffix;
+
+		const int64_t depth(room_state_snapshot_get(val, pos));
+		const event::idx event_idx(room_state_snapshot_get(val, pos));
+		const auto &[type, state_key]
+		{
+			room_state_delta_val(string_view{key_buf, key_len})
+		};
+
+		if(!closure(type, state_key, depth, event_idx))
+			return false;
+	}
+
+	return true;
+}
+
+int64_t
+ircd::m::dbs::room_state_snapshot_base(const string_view &val)
+{
+	size_t pos(0);
+	return int64_t(room_state_snapshot_get(val, pos)) - 1;
+}
+
+/// Integers are encoded from a 128-bit word so the full 64-bit range fits;
+/// depth is remote-supplied and not bounded otherwise.
+void
+ircd::m::dbs::room_state_snapshot_put(std::string &out,
+                                      const uint64_t &val)
+{
+	const uint128_t enc
+	{
+		uleb128::encode(uint128_t(val))
+	};
+
+	out.append(reinterpret_cast<const char *>(&enc), uleb128::length(enc));
+}
+
+uint64_t
+ircd::m::dbs::room_state_snapshot_get(const string_view &val,
+                                      size_t &pos)
+{
+	const size_t remain
+	{
+		pos < size(val)? size(val) - pos: 0UL
+	};
+
+	uint128_t enc(0);
+	memcpy(&enc, data(val) + pos, std::min(remain, sizeof(enc)));
+	const size_t len
+	{
+		uleb128::length(enc)
+	};
+
+	// The bytes of the next integer follow; decode() doesn't stop at the
+	// terminating byte on its own.
+	if(len < sizeof(enc))
+		enc &= (uint128_t(1) << (len * 8)) - 1;
+
+	pos += len;
+	return uint64_t(uleb128::decode(enc));
+}
+
+//
+// key
+//
+
+ircd::string_view
+ircd::m::dbs::room_state_snapshot_key(const mutable_buffer &out_,
+                                      const id::room &room_id,
+                                      const int64_t &depth)
+{
+	assert(room_id);
+	const uint64_t val
+	{
+		hton(~uint64_t(depth))
+	};
+
+	mutable_buffer out{out_};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, const_buffer{reinterpret_cast<const char *>(&val), sizeof(val)}));
+	return { data(out_), data(out) };
+}
+
+int64_t
+ircd::m::dbs::room_state_snapshot_key(const string_view &amalgam)
+{
+	assert(size(amalgam) >= 8);
+	const string_view &val
+	{
+		amalgam.substr(size(amalgam) - 8)
+	};
+
+	return int64_t(~ntoh(uint64_t(byte_view<uint64_t>(val))));
+}
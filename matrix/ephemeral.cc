@@ -0,0 +1,245 @@
+// The Construct
+//
+// Copyright (C) The Construct Developers, Authors & Contributors
+// Copyright (C) 2016-2020 Jason Volk <jason@zemos.net>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice is present in all copies. The
+// full license for this software is available in the LICENSE file.
+
+ircd::m::ephemeral::ephemeral(const string_view &name,
+                              const conf::item<milliseconds> &rate,
+                              write_closure writer)
+:name
+{
+	name
+}
+,rate
+{
+	rate
+}
+,writer
+{
+	std::move(writer)
+}
+,context
+{
+	name,
+	256_KiB,
+	context::POST,
+	std::bind(&ephemeral::worker, this)
+}
+,quit
+{
+	run::level::QUIT, [this]
+	{
+		context.terminate();
+		context.join();
+
+		// Write whatever is still held. Writing yields and the map is
+		// rescanned each time.
+		for(auto it(begin(map)); it != end(map); it = begin(map))
+		{
+			while(it != end(map) && !it->second.pending)
+				++it;
+
+			if(it == end(map))
+				break;
+
+			write(it->first, it->second);
+		}
+
+		pending = 0;
+	}
+}
+{
+}
+
+ircd::m::ephemeral::~ephemeral()
+noexcept
+{
+	if(pending)
+		log::dwarning
+		{
+			log, "%s dropping %zu held updates.",
+			name,
+			pending,
+		};
+}
+
+ircd::m::event::id::buf
+ircd::m::ephemeral::set(const string_view &key,
+                        const json::object &content)
+{
+	auto it(map.lower_bound(key));
+	if(it == end(map) || it->first != key)
+		it = map.emplace_hint(it, std::string{key}, entry{});
+
+	auto &entry(it->second);
+	const auto now
+	{
+		ircd::now<system_point>()
+	};
+
+	const bool through
+	{
+		run::level != run::level::RUN
+		|| entry.last == system_point{}
+		|| now >= entry.last + milliseconds(rate)
+	};
+
+	entry.content = content;
+	if(!through)
+	{
+		coalesced += entry.pending;
+		pending += !entry.pending;
+		entry.pending = true;
+		dock.notify_all();
+		return {};
+	}
+
+	coalesced += entry.pending;
+	pending -= entry.pending;
+	entry.pending = false;
+	entry.written = entry.content;
+	entry.last = now;
+	dock.notify_all();
+	++writes;
+	return writer(key, content);
+}
+
+bool
+ircd::m::ephemeral::get(const string_view &key,
+                        const closure &closure)
+const
+{
+	const auto it
+	{
+		map.find(key)
+	};
+
+	if(it == end(map) || it->second.content.empty())
+		return false;
+
+	// The entry may be erased if the closure yields.
+	const std::string content
+	{
+		it->second.content
+	};
+
+	closure(json::object{content});
+	return true;
+}
+
+void
+ircd::m::ephemeral::worker()
+try
+{
+	while(1)
+	{
+		dock.wait([this]
+		{
+			return !map.empty();
+		});
+
+		ctx::sleep_until(flush());
+	}
+}
+catch(const ctx::terminated &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::critical
+	{
+		log, "%s ephemeral worker fatal :%s",
+		name,
+		e.what(),
+	};
+}
+
+/// Writes the held updates which are due and erases entries whose last write
+/// is older than the interval. Returns the time the next held update is due.
+ircd::system_point
+ircd::m::ephemeral::flush()
+{
+	const auto now
+	{
+		ircd::now<system_point>()
+	};
+
+	system_point next
+	{
+		now + milliseconds(rate)
+	};
+
+	for(auto it(begin(map)); it != end(map); )
+	{
+		auto &[key, entry] {*it};
+		const auto due
+		{
+			entry.last + milliseconds(rate)
+		};
+
+		if(!entry.pending && due <= now)
+		{
+			it = map.erase(it);
+			continue;
+		}
+
+		if(entry.pending && due <= now)
+			write(key, entry);
+		else if(entry.pending)
+			next = std::min(next, due);
+
+		++it;
+	}
+
+	pending = std::count_if(begin(map), end(map), []
+	(const auto &pair)
+	{
+		return pair.second.pending;
+	});
+
+	return next;
+}
+
+void
+ircd::m::ephemeral::write(const std::string &key,
+                          entry &entry)
+try
+{
+	entry.pending = false;
+	if(entry.content == entry.written)
+	{
+		++coalesced;
+		return;
+	}
+
+	// Writing yields; further updates may be held in the meantime.
+	entry.written = entry.content;
+	entry.last = ircd::now<system_point>();
+	const std::string content
+	{
+		entry.content
+	};
+
+	++writes;
+	writer(key, json::object{content});
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		log, "%s writing held update for '%s' :%s",
+		name,
+		key,
+		e.what(),
+	};
+}
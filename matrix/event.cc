@@ -1233,6 +1233,18 @@ ircd::m::event::event(id::buf &buf,
                       const json::object &source,
                       const string_view &version)
 :event
+{
+	buf, json::object::index{source}, version
+}
+{
+}
+
+/// The index is built once for the event_id lookups and the construction
+/// of the tuple; the source object is not parsed again for either.
+ircd::m::event::event(id::buf &buf,
+                      const json::object::index &source,
+                      const string_view &version)
+:event
 {
 	source,
 	version == "1"?
@@ -1240,14 +1252,44 @@ ircd::m::event::event(id::buf &buf,
 	version == "2"?
 		id{json::string(source.get("event_id"))}:
 	version == "3"?
-		id{id::v3{buf, source}}:
+		id{id::v3{buf, source.object}}:
 	version == "4"?
-		id{id::v4{buf, source}}:
+		id{id::v4{buf, source.object}}:
 	source.has("event_id")?
 		id{json::string(source.at("event_id"))}:
-		id{id::v4{buf, source}},
+		id{id::v4{buf, source.object}},
+}
+{
+}
+
+ircd::m::event::event(const json::object::index &source,
+                      const id &event_id)
+try
+:super_type
+{
+	source
+}
+,event_id
+{
+	event_id?
+		event_id:
+	defined(json::get<"event_id"_>(*this))?
+		id{json::get<"event_id"_>(*this)}:
+		id{},
+}
+{
 }
+catch(const json::parse_error &e)
 {
+	log::error
+	{
+		log, "Event %s from JSON source (%zu bytes) :%s",
+		event_id?
+			string_view{event_id}:
+			"<event_id in source>"_sv,
+		string_view{source.object}.size(),
+		e.what(),
+	};
 }
 
 ircd::m::event::event(const json::object &source,
@@ -124,11 +124,13 @@ ircd::m::vm::conform_report
 			return;
 		}
 
-		// Generate the report here.
-		eval.report = event::conforms
-		{
-			event, opts.non_conform.report
-		};
+		// Generate the report here unless it was already generated by the
+		// parallel pre-pass over a vector of events in vm::execute().
+		eval.report = eval.conformed?
+			*eval.conformed:
+			event::conforms{event};
+
+		eval.report.report &= ~opts.non_conform.report;
 
 		// When opts.conforming is false a bad report is not an error.
 		if(!opts.conforming)
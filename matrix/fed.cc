@@ -742,9 +742,15 @@ ircd::m::fed::send_join::send_join(const room::id &room_id,
 		thread_local char ridbuf[768], uidbuf[768];
 		json::get<"uri"_>(opts.request) = fmt::sprintf
 		{
-			buf, "/_matrix/federation/v1/send_join/%s/%s",
+			buf, "/_matrix/federation/%s/send_join/%s/%s%s",
+			opts.omit_members?
+				"v2"_sv:
+				"v1"_sv,
 			url::encode(ridbuf, room_id),
-			url::encode(uidbuf, event_id)
+			url::encode(uidbuf, event_id),
+			opts.omit_members?
+				"?omit_members=true"_sv:
+				string_view{}
 		};
 
 		consume(buf, size(json::get<"uri"_>(opts.request)));
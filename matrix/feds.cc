@@ -441,9 +441,25 @@ ircd::m::feds::for_each_in_room(const opts &opts,
 		opts.room_id
 	};
 
+	// While the state of the room is partial the servers reported at the
+	// join are targeted as well.
+	const auto for_each_origin{[&opts, &origins]
+	(const m::room::origins::closure &closure)
+	{
+		origins.for_each(closure);
+		m::room::state::partial_servers(opts.room_id, [&origins, &closure]
+		(const string_view &origin)
+		{
+			if(!origins.has(origin))
+				closure(origin);
+
+			return true;
+		});
+	}};
+
 	// Prelink loop
 	if(opts.prelink)
-		origins.for_each([&opts]
+		for_each_origin([&opts]
 		(const string_view &origin)
 		{
 			if(opts.exclude_myself && my_host(origin))
@@ -453,7 +469,7 @@ ircd::m::feds::for_each_in_room(const opts &opts,
 		});
 
 	// Request loop
-	origins.for_each([&opts, &ret, &closure, &create_closure]
+	for_each_origin([&opts, &ret, &closure, &create_closure]
 	(const string_view &origin)
 	{
 		if(opts.exclude_myself && my_host(origin))
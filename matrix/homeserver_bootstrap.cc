@@ -10,9 +10,54 @@
 
 namespace ircd::m
 {
+	static size_t bootstrap_bulk(vm::eval &, const vector_view<const json::object> &, const vector_view<m::event> &);
 	static void bootstrap_event_vector(homeserver &);
+
+	extern conf::item<bool> bootstrap_bulk_enable;
+	extern conf::item<size_t> bootstrap_bulk_batch;
+	extern conf::item<size_t> bootstrap_bulk_threads;
 }
 
+decltype(ircd::m::bootstrap_bulk_enable)
+ircd::m::bootstrap_bulk_enable
+{
+	{ "name",     "ircd.m.homeserver.bootstrap.bulk.enable" },
+	{ "default",  false                                     },
+	{ "description",
+
+	R"(
+	Bootstrap an empty database from an event vector by composing the event
+	indexes on several threads and ingesting them as external SST files rather
+	than evaluating each event. Has no effect if the database is not empty.
+	)"},
+};
+
+decltype(ircd::m::bootstrap_bulk_batch)
+ircd::m::bootstrap_bulk_batch
+{
+	{ "name",     "ircd.m.homeserver.bootstrap.bulk.batch" },
+	{ "default",  131072L                                  },
+	{ "description",
+
+	R"(
+	Number of events loaded at a time in bulk mode. Each batch creates one
+	SST file for each column and holds the batch's indexes in memory.
+	)"},
+};
+
+decltype(ircd::m::bootstrap_bulk_threads)
+ircd::m::bootstrap_bulk_threads
+{
+	{ "name",     "ircd.m.homeserver.bootstrap.bulk.threads" },
+	{ "default",  4L                                         },
+	{ "description",
+
+	R"(
+	Number of offload threads which parse, check and index the events of a
+	batch in bulk mode.
+	)"},
+};
+
 void
 ircd::m::homeserver::bootstrap()
 try
@@ -283,8 +328,24 @@ try
 	// Outputs to infolog for each event; may be noisy;
 	vmopts.infolog_accept = false;
 
+	// Bulk mode only applies to a fresh database; see bootstrap_bulk().
+	const bool bulk
+	{
+		bootstrap_bulk_enable
+		&& !validate_json_only
+		&& sequence(*dbs::events) == 0
+	};
+
 	static const size_t batch_max {2048};
-	std::vector<m::event> vec(batch_max);
+	const size_t batch_size
+	{
+		bulk?
+			std::max(size_t(bootstrap_bulk_batch), 1UL):
+			batch_max
+	};
+
+	std::vector<m::event> vec(batch_size);
+	std::vector<json::object> obj(bulk? batch_size: 0UL);
 	size_t count {0}, ebytes[2] {0, 1}, accept {0};
 	vm::eval eval
 	{
@@ -307,6 +368,13 @@ try
 			if(validate_json_only)
 				continue;
 
+			// In bulk mode the event tuple is loaded on the threads
+			if(bulk)
+			{
+				obj[i] = elem;
+				continue;
+			}
+
 			vec[i] = json::object{elem};
 		}
 
@@ -320,6 +388,8 @@ try
 		{
 			validate_json_only?
 				0UL:
+			bulk?
+				bootstrap_bulk(eval, {obj.data(), i}, {vec.data(), i}):
 				execute(eval, batch)
 		};
 
@@ -408,3 +478,258 @@ catch(const ctx::terminated &)
 		server_name(homeserver),
 	};
 }
+
+/// Bulk-load a batch of events into a fresh database. The events are parsed,
+/// checked and given their query-free indexes on the offload threads; each
+/// column's share is then written to an SST file and all of the files are
+/// ingested at once. The indexers which must query the database (refs,
+/// present state, auth chains etc) run here afterward against the ingested
+/// data and are committed as usual. The event_idx is assigned in the order
+/// of the input among the events loaded here. Events without an event_id are
+/// left to vm::execute() because their room version has to be queried; they
+/// are executed after the batch and so are sequenced after all of it.
+size_t
+ircd::m::bootstrap_bulk(vm::eval &eval,
+                        const vector_view<const json::object> &objects,
+                        const vector_view<m::event> &events)
+{
+	assert(eval.opts);
+	assert(objects.size() == events.size());
+	const auto &opts
+	{
+		*eval.opts
+	};
+
+	// Indexes composed on the threads never query the database and have a
+	// key unique to the event (or are a MERGE) so they can go to an SST.
+	static const auto threaded{[]
+	{
+		std::bitset<64> ret;
+		ret.set(dbs::appendix::EVENT_ID);
+		ret.set(dbs::appendix::EVENT_JSON);
+		ret.set(dbs::appendix::EVENT_COLS);
+		ret.set(dbs::appendix::EVENT_SENDER);
+		ret.set(dbs::appendix::EVENT_TYPE);
+		ret.set(dbs::appendix::EVENT_STATE);
+		ret.set(dbs::appendix::ROOM_EVENTS);
+		ret.set(dbs::appendix::ROOM_TYPE);
+		ret.set(dbs::appendix::ROOM_STATE_SPACE);
+		ret.set(dbs::appendix::ROOM_SEARCH);
+		ret.set(dbs::appendix::ROOM_STATE_DELTA);
+		return ret;
+	}()};
+
+	auto &d
+	{
+		*dbs::events
+	};
+
+	const ctx::ole::opts offload_opts
+	{
+		"bootstrap.bulk",
+		std::clamp(size_t(bootstrap_bulk_threads), 1UL, std::max(events.size(), 1UL)),
+	};
+
+	// 1 accept; 0 reject; -1 defer to vm::execute()
+	std::vector<int8_t> state(events.size(), 0);
+	std::atomic<size_t> next {0};
+	ctx::offload
+	{
+		offload_opts, [&]
+		{
+			size_t i; while((i = next++) < events.size()) try
+			{
+				events[i] = m::event
+				{
+					objects[i]
+				};
+
+				if(!events[i].event_id)
+				{
+					state[i] = -1;
+					continue;
+				}
+
+				if(opts.phase[vm::phase::CONFORM] && opts.conforming)
+				{
+					event::conforms report
+					{
+						events[i]
+					};
+
+					report.report &= ~opts.non_conform.report;
+					if(!report.clean())
+						continue;
+				}
+
+				state[i] = 1;
+			}
+			catch(const std::exception &)
+			{
+				state[i] = 0;
+			}
+		}
+	};
+
+	// A duplicate within the batch would repeat its keys in an SST, and one
+	// already in the database would be given a second event_idx; both are
+	// dropped here the same as vm::execute() would find them existing.
+	std::set<string_view> unique;
+	for(size_t i(0); i < events.size(); ++i)
+		if(state[i] > 0)
+			if(!unique.emplace(events[i].event_id).second || m::exists(events[i].event_id))
+				state[i] = 0;
+
+	size_t accepted(0);
+	std::vector<event::idx> idx(events.size(), 0);
+	std::vector<m::event> deferred;
+	for(size_t i(0); i < events.size(); ++i)
+		if(state[i] > 0)
+			idx[i] = vm::sequence::retired + ++accepted;
+		else if(state[i] < 0)
+			deferred.emplace_back(events[i]);
+
+	// Each thread composes into its own transaction.
+	std::vector<std::unique_ptr<db::txn>> txns(offload_opts.concurrency);
+	for(auto &txn : txns)
+		txn = std::make_unique<db::txn>(d);
+
+	std::atomic<size_t> thread {0};
+	next = 0;
+	ctx::offload
+	{
+		offload_opts, [&]
+		{
+			auto &txn
+			{
+				*txns.at(thread++)
+			};
+
+			dbs::write_opts wopts(opts.wopts);
+			wopts.appendix &= threaded;
+			wopts.allow_queries = false;
+			wopts.json_source = opts.json_source;
+			size_t i; while((i = next++) < events.size())
+			{
+				if(!idx[i])
+					continue;
+
+				wopts.event_idx = idx[i];
+				dbs::write(txn, events[i], wopts);
+			}
+		}
+	};
+
+	// SET's are gathered for the SST of their column; anything else is
+	// carried into the transaction committed after the ingestion.
+	using kv = db::database::sst::build::kv;
+	std::map<string_view, std::vector<kv>> sets;
+	db::txn txn
+	{
+		d
+	};
+
+	for(const auto &thread_txn : txns)
+		db::for_each(*thread_txn, [&sets, &txn, &d]
+		(const db::delta &delta)
+		{
+			if(std::get<db::delta::OP>(delta) == db::op::SET)
+				sets[std::get<db::delta::COL>(delta)].emplace_back
+				(
+					std::get<db::delta::KEY>(delta), std::get<db::delta::VAL>(delta)
+				);
+			else
+				db::txn::append
+				{
+					txn, d, delta
+				};
+		});
+
+	const string_view dir_parts[]
+	{
+		fs::base::db, "bootstrap.bulk"
+	};
+
+	const std::string dir
+	{
+		fs::path_string(fs::path_views{dir_parts})
+	};
+
+	fs::mkdir(dir);
+	std::vector<std::string> paths;
+	paths.reserve(sets.size());
+	const unwind remove_files{[&paths]
+	{
+		for(const auto &path : paths)
+			fs::remove(std::nothrow, path);
+	}};
+
+	for(auto &[col, vec] : sets)
+	{
+		const std::string name
+		{
+			fmt::snstringf
+			{
+				fs::NAME_MAX_LEN, "%s.%lu.sst", col, vm::sequence::retired + 1
+			}
+		};
+
+		const string_view path_parts[]
+		{
+			dir, name
+		};
+
+		paths.emplace_back(fs::path_string(fs::path_views{path_parts}));
+		const db::database::sst::build build
+		{
+			d[col], paths.back(), vec
+		};
+	}
+
+	size_t f(0);
+	std::vector<std::pair<string_view, string_view>> files;
+	files.reserve(sets.size());
+	for(const auto &[col, vec] : sets)
+		files.emplace_back(col, paths.at(f++));
+
+	db::ingest(d, vector_view<const std::pair<string_view, string_view>>
+	{
+		files
+	});
+
+	// The remaining indexers can now find the ingested events.
+	dbs::write_opts wopts(opts.wopts);
+	wopts.appendix &= ~threaded;
+	wopts.interpose = &txn;
+	for(size_t i(0); i < events.size(); ++i)
+	{
+		if(!idx[i])
+			continue;
+
+		wopts.event_idx = idx[i];
+		dbs::write(txn, events[i], wopts);
+	}
+
+	txn();
+
+	vm::sequence::retired += accepted;
+	vm::sequence::committed = vm::sequence::retired;
+	vm::sequence::uncommitted = vm::sequence::retired;
+
+	log::debug
+	{
+		log, "Bootstrap bulk batch of %zu accepted:%zu deferred:%zu files:%zu txn:%zu retired:%lu",
+		events.size(),
+		accepted,
+		deferred.size(),
+		sets.size(),
+		txn.size(),
+		vm::sequence::retired,
+	};
+
+	// Events without an event_id take the usual path.
+	if(!deferred.empty())
+		accepted += execute(eval, deferred);
+
+	return accepted;
+}
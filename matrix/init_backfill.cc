@@ -293,6 +293,10 @@ catch(const std::exception &e)
 void
 ircd::m::init::backfill::handle_room(const room::id &room_id)
 {
+	// Resume obtaining the state of a room joined with partial state.
+	if(m::room::state::partial(room_id))
+		m::room::bootstrap::complete(room_id);
+
 	m::acquire::opts opts;
 	opts.head = true;
 	opts.missing = true;
@@ -10,7 +10,11 @@
 
 namespace ircd::m
 {
+	static event::id::buf presence_write(const string_view &, const json::object &);
+
 	extern const string_view presence_valid_states[];
+	extern conf::item<milliseconds> presence_coalesce;
+	extern ephemeral presence_ephemeral;
 }
 
 decltype(ircd::m::presence_valid_states)
@@ -21,6 +25,26 @@ ircd::m::presence_valid_states
 	"unavailable",
 };
 
+decltype(ircd::m::presence_coalesce)
+ircd::m::presence_coalesce
+{
+	{ "name",     "ircd.m.presence.coalesce" },
+	{ "default",  15 * 1000L                 },
+	{ "description",
+
+	R"(
+	Presence of a user is written to the user's room at most once in this
+	interval (milliseconds). Further updates are held in memory and only the
+	latest is written when the interval expires. Zero writes every update.
+	)"},
+};
+
+decltype(ircd::m::presence_ephemeral)
+ircd::m::presence_ephemeral
+{
+	"m.presence", presence_coalesce, presence_write
+};
+
 ircd::m::presence::presence(const user &user,
                             const mutable_buffer &buf)
 :edu::m_presence{[&user, &buf]
@@ -70,6 +94,9 @@ ircd::m::presence::get(std::nothrow_t,
                        const user &user,
                        const closure &closure)
 {
+	if(presence_ephemeral.get(user.user_id, closure))
+		return true;
+
 	static const m::event::fetch::opts fopts
 	{
 		m::event::keys::include {"content"}
@@ -148,12 +175,26 @@ ircd::m::presence::get(const std::nothrow_t,
 	return state.get(std::nothrow, "ircd.presence", "");
 }
 
+/// The update may be held by the presence_ephemeral store, in which case
+/// the returned event_id is empty.
 ircd::m::event::id::buf
 ircd::m::presence::set(const m::presence &content)
+{
+	const json::strung _content
+	{
+		content
+	};
+
+	return presence_ephemeral.set(json::at<"user_id"_>(content), json::object(_content));
+}
+
+ircd::m::event::id::buf
+ircd::m::presence_write(const string_view &user_id,
+                        const json::object &content)
 {
 	const m::user user
 	{
-		json::at<"user_id"_>(content)
+		user_id
 	};
 
 	//TODO: ABA
@@ -166,12 +207,7 @@ ircd::m::presence::set(const m::presence &content)
 		user, &copts
 	};
 
-	const json::strung _content
-	{
-		content
-	};
-
-	return send(user_room, user.user_id, "ircd.presence", "", json::object(_content));
+	return send(user_room, user.user_id, "ircd.presence", "", content);
 }
 
 bool
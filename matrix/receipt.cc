@@ -8,61 +8,112 @@
 // copyright notice and this permission notice is present in all copies. The
 // full license for this software is available in the LICENSE file.
 
+namespace ircd::m::receipt
+{
+	static string_view make_key(const mutable_buffer &, const id::room &, const id::user &);
+	static bool get(const id::room &, const id::user &, const ephemeral::closure &);
+	static event::id::buf write(const string_view &, const json::object &);
+
+	extern conf::item<milliseconds> coalesce;
+	extern ephemeral receipts;
+}
+
 decltype(ircd::m::receipt::log)
 ircd::m::receipt::log
 {
 	"m.receipt"
 };
 
+decltype(ircd::m::receipt::coalesce)
+ircd::m::receipt::coalesce
+{
+	{ "name",     "ircd.m.receipt.coalesce" },
+	{ "default",  3 * 1000L                 },
+	{ "description",
+
+	R"(
+	The receipt of a user in a room is written to the user's room at most
+	once in this interval (milliseconds). Further receipts are held in memory
+	and only the latest is written when the interval expires. Zero writes
+	every receipt.
+	)"},
+};
+
+decltype(ircd::m::receipt::receipts)
+ircd::m::receipt::receipts
+{
+	"m.receipt", coalesce, write
+};
+
+/// The receipt may be held by the receipts store, in which case the
+/// returned event_id is empty.
 ircd::m::event::id::buf
 ircd::m::receipt::read(const m::room::id &room_id,
                        const m::user::id &user_id,
                        const m::event::id &event_id,
                        const json::object &options)
 {
-	const m::user::room user_room
+	const json::strung content{json::members
 	{
-		user_id
-	};
+		{ "event_id",    event_id                                       },
+		{ "ts",          options.get("ts", ircd::time<milliseconds>())  },
+		{ "m.hidden",    options.get("m.hidden", false)                 },
+	}};
 
+	char buf[room::id::MAX_SIZE + 1 + user::id::MAX_SIZE];
 	const auto evid
 	{
-		send(user_room, user_id, "ircd.read", room_id,
-		{
-			{ "event_id",    event_id                                       },
-			{ "ts",          options.get("ts", ircd::time<milliseconds>())  },
-			{ "m.hidden",    options.get("m.hidden", false)                 },
-		})
+		receipts.set(make_key(buf, room_id, user_id), json::object(content))
 	};
 
 	log::info
 	{
-		log, "%s read by %s in %s options:%s",
+		log, "%s read by %s in %s options:%s%s",
 		string_view{event_id},
 		string_view{user_id},
 		string_view{room_id},
 		string_view{options},
+		evid? string_view{}: " (held)"_sv,
 	};
 
 	return evid;
 }
 
-bool
-ircd::m::receipt::get(const m::room::id &room_id,
-                      const m::user::id &user_id,
-                      const m::event::id::closure &closure)
+ircd::m::event::id::buf
+ircd::m::receipt::write(const string_view &key,
+                        const json::object &content)
 {
-	const m::user::room user_room
+	const auto &[room_id, user_id]
 	{
-		user_id
+		split(key, '\0')
 	};
 
-	const auto event_idx
+	const m::user::room user_room
 	{
-		user_room.get(std::nothrow, "ircd.read", room_id)
+		m::user::id{user_id}
 	};
 
-	return m::get(std::nothrow, event_idx, "content", [&closure]
+	return send(user_room, user_id, "ircd.read", room_id, content);
+}
+
+ircd::string_view
+ircd::m::receipt::make_key(const mutable_buffer &buf,
+                           const id::room &room_id,
+                           const id::user &user_id)
+{
+	mutable_buffer out{buf};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, user_id));
+	return { data(buf), data(out) };
+}
+
+bool
+ircd::m::receipt::get(const m::room::id &room_id,
+                      const m::user::id &user_id,
+                      const m::event::id::closure &closure)
+{
+	return get(room_id, user_id, ephemeral::closure{[&closure]
 	(const json::object &content)
 	{
 		const json::string &event_id
@@ -71,9 +122,31 @@ ircd::m::receipt::get(const m::room::id &room_id,
 		};
 
 		closure(event_id);
-	});
+	}});
 }
 
+/// Content of the user's latest receipt in the room, whether held or written.
+bool
+ircd::m::receipt::get(const m::room::id &room_id,
+                      const m::user::id &user_id,
+                      const ephemeral::closure &closure)
+{
+	char buf[room::id::MAX_SIZE + 1 + user::id::MAX_SIZE];
+	if(receipts.get(make_key(buf, room_id, user_id), closure))
+		return true;
+
+	const m::user::room user_room
+	{
+		user_id
+	};
+
+	const auto event_idx
+	{
+		user_room.get(std::nothrow, "ircd.read", room_id)
+	};
+
+	return m::get(std::nothrow, event_idx, "content", closure);
+}
 
 /// Does the user wish to not send receipts for events sent by its specific
 /// sender?
@@ -107,23 +180,13 @@ ircd::m::receipt::freshest(const m::room::id &room_id,
                            const m::event::id &event_id)
 try
 {
-	const m::user::room user_room
-	{
-		user_id
-	};
-
 	bool ret{true};
-	user_room.get("ircd.read", room_id, [&ret, &event_id]
-	(const m::event &event)
+	get(room_id, user_id, ephemeral::closure{[&ret, &event_id]
+	(const json::object &content)
 	{
-		const auto &content
-		{
-			at<"content"_>(event)
-		};
-
 		const m::event::id &previous_id
 		{
-			unquote(content.get("event_id"))
+			json::string(content.get("event_id"))
 		};
 
 		if(event_id == previous_id)
@@ -143,7 +206,7 @@ try
 		};
 
 		ret = event_idx > previous_idx;
-	});
+	}});
 
 	return ret;
 }
@@ -166,22 +229,12 @@ ircd::m::receipt::exists(const m::room::id &room_id,
                          const m::user::id &user_id,
                          const m::event::id &event_id)
 {
-	const m::user::room user_room
-	{
-		user_id
-	};
-
 	bool ret{false};
-	user_room.get(std::nothrow, "ircd.read", room_id, [&ret, &event_id]
-	(const m::event &event)
+	get(room_id, user_id, ephemeral::closure{[&ret, &event_id]
+	(const json::object &content)
 	{
-		const auto &content
-		{
-			at<"content"_>(event)
-		};
-
-		ret = unquote(content.get("event_id")) == event_id;
-	});
+		ret = json::string(content.get("event_id")) == event_id;
+	}});
 
 	return ret;
 }
@@ -843,34 +843,56 @@ const
 	return ret;
 }
 
+bool
+ircd::m::room::auth::chain::has(const event::idx &event_idx)
+const
+{
+	return !for_each([&event_idx](const auto &idx)
+	{
+		return idx != event_idx;
+	});
+}
+
+/// Iterates the auth chain in event_idx order. The auth_events of each event
+/// on the way are read from the event_auth_chain column; only events absent
+/// there (i.e. not a type which can be an auth_event, or written before the
+/// column existed) are fetched to resolve their auth_events.
 bool
 ircd::m::room::auth::chain::for_each(const closure &closure)
 const
 {
-	m::event::fetch e, a;
+	m::event::fetch e;
 	std::set<event::idx> ae;
 	std::deque<event::idx> aq {idx}; do
 	{
 		const auto idx(aq.front());
 		aq.pop_front();
-		if(!seek(std::nothrow, e, idx))
-			continue;
 
-		const event::prev prev{e};
-		const size_t count
+		size_t count(0);
+		event::idx auth_idx[event::prev::MAX];
+		const bool indexed
 		{
-			std::min(prev.auth_events_count(), 5UL)
+			dbs::find_event_auth_chain(idx, [&auth_idx, &count]
+			(const vector_view<const event::idx> &auth_events)
+			{
+				count = std::copy(begin(auth_events), end(auth_events), auth_idx) - auth_idx;
+			})
 		};
 
-		event::id auth_id[count];
-		event::idx auth_idx[count];
-		for(size_t i(0); i < count; ++i)
-			auth_id[i] = prev.auth_event(i);
-
-		const auto found
+		if(!indexed)
 		{
-			m::index({auth_idx, count}, {auth_id, count})
-		};
+			if(!seek(std::nothrow, e, idx))
+				continue;
+
+			const event::prev prev{e};
+			count = std::min(prev.auth_events_count(), event::prev::MAX);
+
+			event::id auth_id[count];
+			for(size_t i(0); i < count; ++i)
+				auth_id[i] = prev.auth_event(i);
+
+			m::index({auth_idx, count}, {auth_id, count});
+		}
 
 		for(size_t i(0); i < count; ++i)
 		{
@@ -880,10 +902,8 @@ const
 			auto it(ae.lower_bound(auth_idx[i]));
 			if(it == end(ae) || *it != auth_idx[i])
 			{
-				seek(std::nothrow, a, auth_idx[i]);
 				ae.emplace_hint(it, auth_idx[i]);
-				if(a.valid)
-					aq.emplace_back(auth_idx[i]);
+				aq.emplace_back(auth_idx[i]);
 			}
 		}
 	}
@@ -11,20 +11,35 @@
 namespace ircd::m::roomstrap
 {
 	struct pkg;
+	struct stream;
 	using send_join_response = std::tuple<json::object, unique_buffer<mutable_buffer>>;
+	using pdus = vector_view<const json::object>;
 
 	static event::id::buf make_join(const string_view &host, const room::id &, const user::id &, const mutable_buffer &);
-	static send_join_response send_join(const string_view &host, const room::id &, const event::id &, const json::object &event);
+	static send_join_response send_join(const string_view &host, const room::id &, const event::id &, const json::object &event, stream &, const vm::opts &, const bool &omit_members);
 	static void broadcast_join(const room &, const event &, const string_view &exclude);
-	static void eval_auth_chain(const json::array &auth_chain, vm::opts);
-	static void eval_state(const json::array &state, vm::opts);
+	static size_t eval_layered(const pdus &, const vm::opts &);
+	static void eval_auth_chain(const pdus &auth_chain, vm::opts);
+	static void eval_state(const pdus &state, vm::opts);
 	static void backfill(const string_view &host, const room::id &, const event::id &, vm::opts);
+	static size_t partial_fetch(const string_view &host, const room::id &, const json::array &ids, const vm::opts &);
+	static void partial_set(const room::id &, const event::id &, const string_view &host, const string_view &room_version, const json::array &servers);
+	static void partial_clear(const room::id &);
 	static void worker(pkg);
 
 	extern conf::item<seconds> make_join_timeout;
 	extern conf::item<seconds> send_join_timeout;
 	extern conf::item<seconds> backfill_timeout;
 	extern conf::item<size_t> backfill_limit;
+	extern conf::item<size_t> eval_concurrency;
+	extern conf::item<bool> partial_enable;
+	extern conf::item<seconds> partial_timeout;
+	extern conf::item<size_t> partial_fetch_concurrency;
+	extern stats::item<uint64_t> stats_received;
+	extern stats::item<uint64_t> stats_parsed;
+	extern stats::item<uint64_t> stats_layers;
+	extern stats::item<uint64_t> stats_evaluated;
+	extern stats::item<uint64_t> stats_accepted;
 	extern log::log log;
 }
 
@@ -36,6 +51,48 @@ struct ircd::m::roomstrap::pkg
 	std::string room_version;
 };
 
+/// Incremental reader of the send_join response content. It is fed from the
+/// request's progress callback as the content arrives and finds each element
+/// of the auth_chain and state arrays without waiting for the rest of the
+/// response. The elements are views into the content buffer; this requires
+/// the content to be received into one buffer in place. When it is not (i.e.
+/// chunked encoding) the arrays are taken from the response at completion.
+struct ircd::m::roomstrap::stream
+{
+	enum array :uint8_t
+	{
+		AUTH_CHAIN,
+		STATE,
+		_NUM_
+	};
+
+	const char *base {nullptr};
+	size_t pos {0};
+	size_t depth {0};
+	size_t array_depth {0};
+	size_t key_depth {0};
+	size_t str_depth {0};
+	const char *elem {nullptr};
+	const char *str {nullptr};
+	string_view last;
+	string_view key;
+	int8_t cur {-1};
+	bool quote {false};
+	bool escape {false};
+	bool broken {false};
+	bool done[_NUM_] {false};
+	bool evaluated[_NUM_] {false};
+	std::vector<json::object> events[_NUM_];
+
+	bool ready(const array &a) const
+	{
+		return !broken && done[a];
+	}
+
+	void operator()(const const_buffer &content);
+	void complete(const const_buffer &content, const json::object &response);
+};
+
 decltype(ircd::m::roomstrap::log)
 ircd::m::roomstrap::log
 {
@@ -77,6 +134,90 @@ ircd::m::roomstrap::make_join_timeout
 	{ "default",  15L                                        },
 };
 
+decltype(ircd::m::roomstrap::eval_concurrency)
+ircd::m::roomstrap::eval_concurrency
+{
+	{ "name",     "ircd.client.rooms.join.eval.concurrency" },
+	{ "default",  8L                                        },
+	{ "description",
+
+	R"(
+	Number of contexts evaluating the independent events of the auth_chain
+	and state received from send_join at the same time.
+	)"}
+};
+
+decltype(ircd::m::roomstrap::partial_enable)
+ircd::m::roomstrap::partial_enable
+{
+	{ "name",     "ircd.client.rooms.join.partial.enable" },
+	{ "default",  true                                    },
+	{ "description",
+
+	R"(
+	Request send_join with the membership omitted from the state. The join
+	completes with the state which remains; the members and any other state
+	are obtained afterward while the room is marked partial. Remotes which
+	don't have the v2 send_join endpoint are asked again with v1 and return
+	the full state as before.
+	)"}
+};
+
+decltype(ircd::m::roomstrap::partial_timeout)
+ircd::m::roomstrap::partial_timeout
+{
+	{ "name",     "ircd.client.rooms.join.partial.timeout" },
+	{ "default",  90L                                      },
+};
+
+decltype(ircd::m::roomstrap::partial_fetch_concurrency)
+ircd::m::roomstrap::partial_fetch_concurrency
+{
+	{ "name",     "ircd.client.rooms.join.partial.fetch.concurrency" },
+	{ "default",  32L                                                },
+	{ "description",
+
+	R"(
+	Number of missing state events fetched at the same time while completing
+	the state of a room after a partial join.
+	)"}
+};
+
+decltype(ircd::m::roomstrap::stats_received)
+ircd::m::roomstrap::stats_received
+{
+	{ "name", "ircd.m.room.bootstrap.received"                           },
+	{ "desc", "Number of send_join events read from responses as they arrive." },
+};
+
+decltype(ircd::m::roomstrap::stats_parsed)
+ircd::m::roomstrap::stats_parsed
+{
+	{ "name", "ircd.m.room.bootstrap.parsed"                             },
+	{ "desc", "Number of send_join events parsed and identified."        },
+};
+
+decltype(ircd::m::roomstrap::stats_layers)
+ircd::m::roomstrap::stats_layers
+{
+	{ "name", "ircd.m.room.bootstrap.layers"                             },
+	{ "desc", "Number of topological layers of send_join events evaluated." },
+};
+
+decltype(ircd::m::roomstrap::stats_evaluated)
+ircd::m::roomstrap::stats_evaluated
+{
+	{ "name", "ircd.m.room.bootstrap.evaluated"                          },
+	{ "desc", "Number of send_join events evaluated."                    },
+};
+
+decltype(ircd::m::roomstrap::stats_accepted)
+ircd::m::roomstrap::stats_accepted
+{
+	{ "name", "ircd.m.room.bootstrap.accepted"                           },
+	{ "desc", "Number of send_join events accepted by evaluation."       },
+};
+
 //
 // m::room::bootstrap
 //
@@ -225,43 +366,61 @@ try
 		host
 	};
 
+	m::vm::opts vmopts;
+	vmopts.infolog_accept = false;
+	vmopts.warnlog &= ~vm::fault::EXISTS;
+	vmopts.nothrows = -1;
+	vmopts.room_version = room_version;
+	vmopts.phase.reset(m::vm::phase::FETCH_PREV);
+	vmopts.phase.reset(m::vm::phase::FETCH_STATE);
+	vmopts.notify_servers = false;
+
+	// The auth_chain may already be evaluated by send_join() while the rest
+	// of the response was still being received.
 	assert(event.source);
+	m::roomstrap::stream stream;
 	const auto &[response, buf]
 	{
-		m::roomstrap::send_join(host, room_id, event_id, event.source)
+		m::roomstrap::send_join(host, room_id, event_id, event.source, stream, vmopts, bool(m::roomstrap::partial_enable))
 	};
 
-	const json::array &auth_chain
+	const auto &auth_chain
 	{
-		response["auth_chain"]
+		stream.events[stream.AUTH_CHAIN]
 	};
 
-	const json::array &state
+	const auto &state
 	{
-		response["state"]
+		stream.events[stream.STATE]
+	};
+
+	// The remote omitted the membership from the state; the room is usable
+	// with what remains and the rest is obtained after the join below.
+	const bool partial
+	{
+		response["members_omitted"] == "true"
 	};
 
 	log::info
 	{
-		log, "Joined to %s for %s at %s to '%s' state:%zu auth_chain:%zu",
+		log, "Joined to %s for %s at %s to '%s' state:%zu auth_chain:%zu partial:%b",
 		string_view{room_id},
 		string_view{user_id},
 		string_view{event_id},
 		host,
 		state.size(),
 		auth_chain.size(),
+		partial,
 	};
 
-	m::vm::opts vmopts;
-	vmopts.infolog_accept = false;
-	vmopts.warnlog &= ~vm::fault::EXISTS;
-	vmopts.nothrows = -1;
-	vmopts.room_version = room_version;
-	vmopts.phase.reset(m::vm::phase::FETCH_PREV);
-	vmopts.phase.reset(m::vm::phase::FETCH_STATE);
-	vmopts.notify_servers = false;
+	// Recorded before any state is evaluated so readers never see the
+	// incomplete state without the mark.
+	if(partial)
+		m::roomstrap::partial_set(room_id, event_id, host, room_version, response["servers_in_room"]);
+
+	if(!stream.evaluated[stream.AUTH_CHAIN])
+		m::roomstrap::eval_auth_chain(auth_chain, vmopts);
 
-	m::roomstrap::eval_auth_chain(auth_chain, vmopts);
 	m::roomstrap::eval_state(state, vmopts);
 	m::roomstrap::backfill(host, room_id, event_id, vmopts);
 
@@ -291,6 +450,10 @@ try
 		string_view{event_id},
 		num_reset,
 	};
+
+	// This context is already detached from the client's join request.
+	if(partial)
+		complete(room_id);
 }
 catch(const std::exception &e)
 {
@@ -304,10 +467,274 @@ catch(const std::exception &e)
 	};
 }
 
+/// Obtains the remainder of the state of a room joined with partial state
+/// (see room::state::partial()) from the server which conducted the join.
+/// The state_ids at the join event are requested and the missing events are
+/// fetched and evaluated; m::acquire then fills anything referenced but still
+/// missing. The partial mark is cleared when nothing failed; otherwise it
+/// remains for another attempt. Returns true if the state is complete.
+bool
+ircd::m::room::bootstrap::complete(const id &room_id)
+try
+{
+	const m::room::id::buf ircd_room_id
+	{
+		"ircd", origin(my())
+	};
+
+	const m::room::state ircd_state
+	{
+		ircd_room_id
+	};
+
+	const std::string record
+	{
+		m::get(std::nothrow, ircd_state.get(std::nothrow, "ircd.room.partial", room_id), "content")
+	};
+
+	const json::object content
+	{
+		record
+	};
+
+	const json::string event_id
+	{
+		content["event_id"]
+	};
+
+	const json::string host
+	{
+		content["host"]
+	};
+
+	if(!event_id)
+		return true;
+
+	log::info
+	{
+		log, "Completing partial state of %s at %s from '%s'",
+		string_view{room_id},
+		string_view{event_id},
+		string_view{host},
+	};
+
+	m::vm::opts vmopts;
+	vmopts.infolog_accept = false;
+	vmopts.warnlog &= ~vm::fault::EXISTS;
+	vmopts.nothrows = -1;
+	vmopts.room_version = json::string(content["room_version"]);
+	vmopts.phase.reset(m::vm::phase::FETCH_PREV);
+	vmopts.phase.reset(m::vm::phase::FETCH_STATE);
+	vmopts.notify_servers = false;
+
+	// The state at the join may be older than state which arrived since; the
+	// present state is rebuilt by depth below rather than overwritten here.
+	// These events must not become heads of the room either.
+	vmopts.wopts.appendix[dbs::appendix::ROOM_STATE] = false;
+	vmopts.wopts.appendix[dbs::appendix::ROOM_JOINED] = false;
+	vmopts.wopts.appendix[dbs::appendix::ROOM_HEAD] = false;
+	vmopts.wopts.appendix[dbs::appendix::ROOM_HEAD_RESOLVE] = false;
+
+	const unique_buffer<mutable_buffer> buf
+	{
+		16_KiB // headers in and out
+	};
+
+	m::fed::state::opts opts;
+	opts.remote = host;
+	opts.event_id = event_id;
+	opts.ids_only = true;
+	m::fed::state request
+	{
+		room_id, buf, std::move(opts)
+	};
+
+	request.wait(seconds(m::roomstrap::partial_timeout));
+	request.get();
+
+	const json::object response
+	{
+		request
+	};
+
+	const size_t failed
+	{
+		m::roomstrap::partial_fetch(host, room_id, response["pdu_ids"], vmopts)
+	};
+
+	m::acquire::opts aopts;
+	aopts.hint = host;
+	aopts.missing = true;
+	aopts.head_reset = true;
+	m::acquire::acquire
+	{
+		m::room{room_id}, aopts
+	};
+
+	const m::room::state::rebuild rebuild
+	{
+		room_id
+	};
+
+	if(!failed)
+		m::roomstrap::partial_clear(room_id);
+
+	log::notice
+	{
+		log, "Completed partial state of %s at %s from '%s' failed:%zu",
+		string_view{room_id},
+		string_view{event_id},
+		string_view{host},
+		failed,
+	};
+
+	return !failed;
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		log, "Completing partial state of %s :%s",
+		string_view{room_id},
+		e.what(),
+	};
+
+	return false;
+}
+
 //
 // m::roomstrap
 //
 
+/// Fetches and evaluates the events of ids we don't have. Returns the
+/// number which could not be obtained.
+size_t
+ircd::m::roomstrap::partial_fetch(const string_view &host,
+                                  const m::room::id &room_id,
+                                  const json::array &ids,
+                                  const vm::opts &vmopts)
+{
+	std::vector<event::id> missing;
+	for(const json::string event_id : ids)
+		if(!m::exists(event::id(event_id)))
+			missing.emplace_back(event_id);
+
+	log::info
+	{
+		log, "Fetching %zu of %zu state events missing from %s off '%s'",
+		missing.size(),
+		ids.size(),
+		string_view{room_id},
+		host,
+	};
+
+	const size_t concurrency
+	{
+		std::max(size_t(partial_fetch_concurrency), 1UL)
+	};
+
+	size_t failed(0);
+	std::vector<ctx::future<m::fetch::result>> futures;
+	for(size_t i(0); i < missing.size(); i += concurrency)
+	{
+		futures.clear();
+		for(size_t j(i); j < std::min(i + concurrency, missing.size()); ++j)
+		{
+			m::fetch::opts opts;
+			opts.op = m::fetch::op::event;
+			opts.room_id = room_id;
+			opts.event_id = missing[j];
+			opts.hint = host;
+			futures.emplace_back(m::fetch::start(opts));
+		}
+
+		auto fetching
+		{
+			ctx::when_all(begin(futures), end(futures))
+		};
+
+		fetching.wait(seconds(partial_timeout), std::nothrow);
+		for(auto &future : futures) try
+		{
+			const m::fetch::result result
+			{
+				future.get()
+			};
+
+			const json::object content
+			{
+				result
+			};
+
+			const json::array &pdus
+			{
+				content["pdus"]
+			};
+
+			m::vm::eval
+			{
+				pdus, vmopts
+			};
+		}
+		catch(const ctx::interrupted &)
+		{
+			throw;
+		}
+		catch(const std::exception &e)
+		{
+			++failed;
+			log::derror
+			{
+				log, "Fetching partial state of %s off '%s' :%s",
+				string_view{room_id},
+				host,
+				e.what(),
+			};
+		}
+	}
+
+	return failed;
+}
+
+void
+ircd::m::roomstrap::partial_set(const m::room::id &room_id,
+                                const m::event::id &event_id,
+                                const string_view &host,
+                                const string_view &room_version,
+                                const json::array &servers)
+{
+	const m::room::id::buf ircd_room_id
+	{
+		"ircd", origin(my())
+	};
+
+	send(m::room{ircd_room_id}, me(), "ircd.room.partial", room_id,
+	{
+		{ "event_id",      event_id                         },
+		{ "host",          host                             },
+		{ "room_version",  room_version                     },
+		{ "servers",       servers?: json::empty_array      },
+	});
+}
+
+void
+ircd::m::roomstrap::partial_clear(const m::room::id &room_id)
+{
+	const m::room::id::buf ircd_room_id
+	{
+		"ircd", origin(my())
+	};
+
+	send(m::room{ircd_room_id}, me(), "ircd.room.partial", room_id, json::object
+	{
+		json::empty_object
+	});
+}
+
 void
 ircd::m::roomstrap::worker(pkg pkg)
 try
@@ -502,7 +929,7 @@ catch(const std::exception &e)
 }
 
 void
-ircd::m::roomstrap::eval_state(const json::array &state,
+ircd::m::roomstrap::eval_state(const pdus &state,
                                vm::opts vmopts)
 try
 {
@@ -512,9 +939,16 @@ try
 		state.size(),
 	};
 
-	m::vm::eval
+	const auto accepted
 	{
-		state, vmopts
+		eval_layered(state, vmopts)
+	};
+
+	log::info
+	{
+		log, "Evaluated %zu state events; accepted %zu",
+		state.size(),
+		accepted,
 	};
 }
 catch(const std::exception &e)
@@ -531,7 +965,7 @@ catch(const std::exception &e)
 }
 
 void
-ircd::m::roomstrap::eval_auth_chain(const json::array &auth_chain,
+ircd::m::roomstrap::eval_auth_chain(const pdus &auth_chain,
                                     vm::opts vmopts)
 try
 {
@@ -543,9 +977,16 @@ try
 
 	vmopts.nothrows = vm::fault::EXISTS;
 	vmopts.fetch = false;
-	m::vm::eval
+	const auto accepted
 	{
-		auth_chain, vmopts
+		eval_layered(auth_chain, vmopts)
+	};
+
+	log::info
+	{
+		log, "Evaluated %zu authentication events; accepted %zu",
+		auth_chain.size(),
+		accepted,
 	};
 }
 catch(const std::exception &e)
@@ -560,11 +1001,188 @@ catch(const std::exception &e)
 	throw;
 }
 
+/// Evaluates the events in topological order of their auth_events among the
+/// set. Each layer depends only on the layers before it, so the events of a
+/// layer are independent of each other; each layer is divided among several
+/// contexts which verify and index their share concurrently (the vm orders
+/// the writes). The events are parsed and their event_id computed on the
+/// offload threads first. Returns the number accepted.
+size_t
+ircd::m::roomstrap::eval_layered(const pdus &pdus,
+                                 const vm::opts &vmopts)
+{
+	const size_t num
+	{
+		pdus.size()
+	};
+
+	const size_t concurrency
+	{
+		std::clamp(size_t(eval_concurrency), 1UL, std::max(num, 1UL))
+	};
+
+	std::vector<event::id::buf> ids(num);
+	std::vector<m::event> events(num);
+	std::atomic<size_t> next {0};
+	const ctx::ole::opts offload_opts
+	{
+		"m.room.bootstrap", concurrency
+	};
+
+	ctx::offload
+	{
+		offload_opts, [&]
+		{
+			size_t i; while((i = next++) < num) try
+			{
+				events[i] = m::event
+				{
+					ids[i], pdus[i], vmopts.room_version
+				};
+			}
+			catch(const std::exception &)
+			{
+				events[i] = m::event{};
+			}
+		}
+	};
+
+	stats_parsed += num;
+
+	// Edges from each auth_event to the events it authorizes within the set;
+	// events which fail to parse and repeats of an event_id are dropped here.
+	std::unordered_map<string_view, size_t> pos;
+	pos.reserve(num);
+	for(size_t i(0); i < num; ++i)
+		if(events[i].event_id && !pos.emplace(events[i].event_id, i).second)
+			events[i] = m::event{};
+
+	std::vector<std::vector<size_t>> children(num);
+	std::vector<size_t> indegree(num, 0), layer;
+	for(size_t i(0); i < num; ++i)
+	{
+		if(!events[i].event_id)
+			continue;
+
+		const event::prev prev
+		{
+			events[i]
+		};
+
+		for(size_t j(0); j < prev.auth_events_count(); ++j)
+		{
+			const auto it
+			{
+				pos.find(prev.auth_event(j))
+			};
+
+			if(it == end(pos) || it->second == i)
+				continue;
+
+			children[it->second].emplace_back(i);
+			++indegree[i];
+		}
+
+		if(!indegree[i])
+			layer.emplace_back(i);
+	}
+
+	static const ctx::pool::opts pool_opts
+	{
+		512_KiB,               // stack sz
+		0,                     // pool sz
+		-1,                    // queue max hard
+		0,                     // queue max soft
+		true,                  // queue max blocking
+		true,                  // queue max warning
+	};
+
+	ctx::pool pool
+	{
+		"m.room.bootstrap", pool_opts
+	};
+
+	pool.add(concurrency);
+	size_t accepted(0), evaluated(0);
+	std::vector<m::event> batch;
+	std::vector<vector_view<const m::event>> slices;
+	while(evaluated < pos.size())
+	{
+		// A cycle would leave events with their indegree forever; they are
+		// given to the vm as a last layer in the order received.
+		if(layer.empty())
+			for(size_t i(0); i < num; ++i)
+				if(events[i].event_id && indegree[i] != -1UL)
+					layer.emplace_back(i);
+
+		batch.clear();
+		for(const auto &i : layer)
+		{
+			batch.emplace_back(events[i]);
+			indegree[i] = -1UL;
+		}
+
+		std::sort(begin(batch), end(batch));
+		const size_t slice_size
+		{
+			(batch.size() + concurrency - 1) / concurrency
+		};
+
+		slices.clear();
+		for(size_t i(0); i < batch.size(); i += slice_size)
+			slices.emplace_back(batch.data() + i, std::min(slice_size, batch.size() - i));
+
+		ctx::concurrent_for_each<vector_view<const m::event>>
+		{
+			pool, slices, [&vmopts, &accepted](auto &slice)
+			{
+				vm::eval eval
+				{
+					vmopts
+				};
+
+				const auto count
+				{
+					execute(eval, slice)
+				};
+
+				accepted += count;
+				stats_accepted += count;
+				stats_evaluated += slice.size();
+			}
+		};
+
+		std::vector<size_t> next_layer;
+		for(const auto &i : layer)
+			for(const auto &child : children[i])
+				if(indegree[child] != -1UL && --indegree[child] == 0)
+					next_layer.emplace_back(child);
+
+		evaluated += layer.size();
+		layer = std::move(next_layer);
+		++stats_layers;
+
+		log::debug
+		{
+			log, "Evaluated layer of %zu events; %zu of %zu; accepted:%zu",
+			batch.size(),
+			evaluated,
+			pos.size(),
+			accepted,
+		};
+	}
+
+	return accepted;
+}
+
 ircd::m::roomstrap::send_join_response
 ircd::m::roomstrap::send_join(const string_view &host,
                               const m::room::id &room_id,
                               const m::event::id &event_id,
-                              const json::object &event)
+                              const json::object &event,
+                              stream &stream,
+                              const vm::opts &vmopts,
+                              const bool &omit_members)
 try
 {
 	const unique_buffer<mutable_buffer> buf
@@ -572,34 +1190,75 @@ try
 		16_KiB // headers in and out
 	};
 
-	m::fed::send_join::opts opts{host};
+	m::fed::send_join::opts opts;
+	opts.remote = host;
+	opts.omit_members = omit_members;
 	m::fed::send_join send_join
 	{
 		room_id, event_id, event, buf, std::move(opts)
 	};
 
-	send_join.wait(seconds(send_join_timeout));
+	// Nothing is received before this context yields.
+	send_join.in.progress = [&stream]
+	(const const_buffer &, const const_buffer &content)
+	{
+		stream(content);
+	};
 
-	const auto send_join_code
+	// The auth_chain is evaluated as soon as it has been received while the
+	// remainder of the response is still arriving.
+	// The time spent evaluating doesn't count against the remote.
+	auto deadline
 	{
-		send_join.get()
+		now<system_point>() + seconds(send_join_timeout)
 	};
 
-	const json::array send_join_response
+	while(!send_join.wait(milliseconds(250), std::nothrow))
+	{
+		if(now<system_point>() >= deadline)
+			break;
+
+		if(!stream.ready(stream.AUTH_CHAIN) || stream.evaluated[stream.AUTH_CHAIN])
+			continue;
+
+		// The stream doesn't add to an array once it's done, but the copy
+		// guarantees the views given to the offload threads stay put.
+		const std::vector<json::object> auth_chain
+		{
+			stream.events[stream.AUTH_CHAIN]
+		};
+
+		const auto started
+		{
+			now<system_point>()
+		};
+
+		stream.evaluated[stream.AUTH_CHAIN] = true;
+		eval_auth_chain(auth_chain, vmopts);
+		deadline += now<system_point>() - started;
+	}
+
+	send_join.wait_until(deadline);
+
+	const auto send_join_code
 	{
-		send_join
+		send_join.get()
 	};
 
-	const uint more_send_join_code
+	// The v1 response is the [code, object] array; v2 is the object itself.
+	const string_view &content
 	{
-		send_join_response.at<uint>(0)
+		send_join.in.content
 	};
 
 	const json::object &send_join_response_data
 	{
-		send_join_response[1]
+		json::type(content) == json::ARRAY?
+			json::object{json::array{content}[1]}:
+			json::object{content}
 	};
 
+	stream.complete(send_join.in.content, send_join_response_data);
 	assert(!!send_join.in.dynamic);
 	return
 	{
@@ -607,6 +1266,35 @@ try
 		std::move(send_join.in.dynamic)
 	};
 }
+catch(const http::error &e)
+{
+	// The remote doesn't have the v2 endpoint; ask again for the full state.
+	if(omit_members && e.code == http::NOT_FOUND)
+	{
+		log::dwarning
+		{
+			log, "Bootstrap %s @ %s send_join v2 to %s not found; trying v1",
+			string_view{room_id},
+			string_view{event_id},
+			string(host),
+		};
+
+		stream = {};
+		return send_join(host, room_id, event_id, event, stream, vmopts, false);
+	}
+
+	log::error
+	{
+		log, "Bootstrap %s @ %s send_join to %s :%s :%s",
+		string_view{room_id},
+		string_view{event_id},
+		string(host),
+		e.what(),
+		e.content,
+	};
+
+	throw;
+}
 catch(const std::exception &e)
 {
 	log::error
@@ -777,3 +1465,143 @@ ircd::m::room::bootstrap::required(const id &room_id)
 
 	return false;
 }
+
+//
+// roomstrap::stream
+//
+
+void
+ircd::m::roomstrap::stream::operator()(const const_buffer &content)
+{
+	if(broken)
+		return;
+
+	if(!base)
+		base = data(content);
+
+	// The content is not being received into the same buffer in place; the
+	// elements found so far can't be relied on.
+	if(unlikely(base != data(content) || size(content) < pos))
+	{
+		broken = true;
+		return;
+	}
+
+	const size_t received
+	{
+		events[AUTH_CHAIN].size() + events[STATE].size()
+	};
+
+	for(; pos < size(content); ++pos)
+	{
+		const char *const c
+		{
+			base + pos
+		};
+
+		if(quote)
+		{
+			if(escape)
+				escape = false;
+			else if(*c == '\\')
+				escape = true;
+			else if(*c == '"')
+			{
+				quote = false;
+				last = string_view{str, c};
+				str_depth = depth;
+			}
+
+			continue;
+		}
+
+		switch(*c)
+		{
+			case '"':
+				quote = true;
+				str = c + 1;
+				continue;
+
+			case ':':
+				key = last;
+				key_depth = str_depth;
+				continue;
+
+			case '{':
+			case '[':
+				++depth;
+
+				// The arrays are members of the response object, which is
+				// either the top level or the second element of it (v1).
+				// A repeated key is ignored; an array is only read once.
+				if(*c == '[' && cur < 0 && depth <= 3 && key_depth + 1 == depth)
+				{
+					const int8_t a
+					{
+						key == "auth_chain"? int8_t(AUTH_CHAIN):
+						key == "state"? int8_t(STATE):
+						int8_t(-1)
+					};
+
+					if(a >= 0 && !done[a])
+					{
+						cur = a;
+						array_depth = depth;
+					}
+				}
+				else if(*c == '{' && cur >= 0 && depth == array_depth + 1)
+					elem = c;
+
+				continue;
+
+			case '}':
+			case ']':
+				if(*c == '}' && cur >= 0 && depth == array_depth + 1)
+					events[cur].emplace_back(string_view{elem, c + 1});
+
+				if(*c == ']' && cur >= 0 && depth == array_depth)
+				{
+					done[cur] = true;
+					cur = -1;
+				}
+
+				depth -= bool(depth);
+				continue;
+		}
+	}
+
+	stats_received += events[AUTH_CHAIN].size() + events[STATE].size() - received;
+}
+
+/// Called with the complete content when the request has finished. Any array
+/// not read by the stream is taken from the response instead.
+void
+ircd::m::roomstrap::stream::complete(const const_buffer &content,
+                                     const json::object &response)
+{
+	operator()(content);
+
+	static const string_view name[_NUM_]
+	{
+		"auth_chain", "state"
+	};
+
+	for(uint8_t a(0); a < _NUM_; ++a)
+	{
+		if(evaluated[a] || ready(array(a)))
+			continue;
+
+		const json::array &pdus
+		{
+			response[name[a]]
+		};
+
+		events[a].clear();
+		events[a].reserve(pdus.size());
+		for(const json::object pdu : pdus)
+			events[a].emplace_back(pdu);
+
+		done[a] = true;
+		stats_received += events[a].size();
+	}
+}
@@ -777,6 +777,17 @@ ircd::m::room::state::is(std::nothrow_t,
 	return ret;
 }
 
+/// The state of a room joined with the membership omitted by the remote is
+/// incomplete until room::bootstrap has obtained the remainder. This is
+/// recorded in our ircd room by an ircd.room.partial state event keyed by the
+/// room_id; the content is emptied when the state is complete.
+bool
+ircd::m::room::state::partial()
+const
+{
+	return partial(room_id);
+}
+
 size_t
 ircd::m::room::state::purge_replaced(const room::id &room_id)
 {
@@ -809,6 +820,71 @@ ircd::m::room::state::purge_replaced(const room::id &room_id)
 	return ret;
 }
 
+bool
+ircd::m::room::state::partial(const room::id &room_id)
+{
+	const m::room::id::buf ircd_room_id
+	{
+		"ircd", origin(my())
+	};
+
+	const m::room::state state
+	{
+		ircd_room_id
+	};
+
+	const auto event_idx
+	{
+		state.get(std::nothrow, "ircd.room.partial", room_id)
+	};
+
+	bool ret{false};
+	m::get(std::nothrow, event_idx, "content", [&ret]
+	(const json::object &content)
+	{
+		ret = content.has("event_id");
+	});
+
+	return ret;
+}
+
+/// Iterates the servers_in_room reported by the resident server when a room
+/// was joined with partial state; until the state is complete some of these
+/// aren't known from the state we hold. Nothing is iterated otherwise.
+bool
+ircd::m::room::state::partial_servers(const room::id &room_id,
+                                      const std::function<bool (const string_view &)> &closure)
+{
+	const m::room::id::buf ircd_room_id
+	{
+		"ircd", origin(my())
+	};
+
+	const m::room::state state
+	{
+		ircd_room_id
+	};
+
+	const auto event_idx
+	{
+		state.get(std::nothrow, "ircd.room.partial", room_id)
+	};
+
+	bool ret{true};
+	m::get(std::nothrow, event_idx, "content", [&closure, &ret]
+	(const json::object &content)
+	{
+		if(!content.has("event_id"))
+			return;
+
+		for(const json::string server : json::array(content["servers"]))
+			if(!(ret = closure(server)))
+				break;
+	});
+
+	return ret;
+}
+
 bool
 ircd::m::room::state::present(const event::idx &event_idx)
 {
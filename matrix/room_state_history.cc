@@ -8,6 +8,46 @@
 // copyright notice and this permission notice is present in all copies. The
 // full license for this software is available in the LICENSE file.
 
+decltype(ircd::m::room::state::history::snapshot_enable)
+ircd::m::room::state::history::snapshot_enable
+{
+	{ "name",     "ircd.m.room.state.history.snapshot.enable" },
+	{ "default",  true                                        },
+	{ "description",
+
+	R"(
+	Iterate the state of a room at a past event by reconstructing it from a
+	snapshot and the state events after it, rather than scanning the entire
+	state space of the room.
+	)"}
+};
+
+decltype(ircd::m::room::state::history::snapshot_interval)
+ircd::m::room::state::history::snapshot_interval
+{
+	{ "name",     "ircd.m.room.state.history.snapshot.interval" },
+	{ "default",  256L                                          },
+	{ "description",
+
+	R"(
+	A snapshot of the state is stored when a reconstruction applies at least
+	this many state events after the nearest snapshot; this bounds the work
+	of later lookups nearby.
+	)"}
+};
+
+decltype(ircd::m::room::state::history::snapshot_diff_max)
+ircd::m::room::state::history::snapshot_diff_max
+{
+	{ "name",     "ircd.m.room.state.history.snapshot.diff.max" },
+	{ "default",  50L                                           },
+	{ "description",
+
+	R"(
+	A snapshot is stored as the difference from its keyframe unless more than
+	this percentage of the state differs; it is then stored as a new keyframe.
+	)"}
+};
 
 //
 // room::state::history
@@ -168,6 +208,22 @@ ircd::m::room::state::history::for_each(const string_view &type,
                                         const closure &closure)
 const
 {
+	// The entire state is reconstructed from a snapshot when possible; a
+	// type or cell is only a small part of the state space to scan.
+	if(!type && bound > -1 && snapshot_enable)
+	{
+		const snapshot snapshot
+		{
+			space.room.room_id, bound
+		};
+
+		if(snapshot.complete && snapshot.deltas >= size_t(snapshot_interval))
+			snapshot.save();
+
+		if(snapshot.complete)
+			return snapshot.for_each(closure);
+	}
+
 	char type_buf[m::event::TYPE_MAX_SIZE];
 	char state_key_buf[m::event::STATE_KEY_MAX_SIZE];
 
@@ -195,3 +251,310 @@ const
 		return true;
 	});
 }
+
+//
+// room::state::history::snapshot
+//
+
+ircd::m::room::state::history::snapshot::snapshot(const room::id &room_id,
+                                                  const int64_t &bound)
+:room_id
+{
+	room_id
+}
+,bound
+{
+	bound
+}
+,retired
+{
+	vm::sequence::retired
+}
+{
+	char buf[dbs::ROOM_STATE_SNAPSHOT_KEY_MAX_SIZE];
+	auto it
+	{
+		dbs::room_state_snapshot.begin(dbs::room_state_snapshot_key(buf, room_id, bound))
+	};
+
+	// The first snapshot found is the nearest at or below the bound.
+	if(it)
+	{
+		const int64_t depth
+		{
+			dbs::room_state_snapshot_key(it->first)
+		};
+
+		const string_view val
+		{
+			it->second
+		};
+
+		const int64_t _keyframe
+		{
+			dbs::room_state_snapshot_base(val)
+		};
+
+		const bool found
+		{
+			_keyframe < 0?
+				apply(val, false):
+				dbs::room_state_snapshot(dbs::room_state_snapshot_key(buf, room_id, _keyframe), std::nothrow, [this]
+				(const string_view &val)
+				{
+					apply(val, false);
+				})
+		};
+
+		if(found && _keyframe >= 0)
+			apply(val, true);
+
+		base = found? depth : -1L;
+		keyframe = found? (_keyframe < 0? depth : _keyframe) : -1L;
+		if(!found)
+			cells.clear();
+	}
+
+	char key_buf[dbs::ROOM_STATE_DELTA_KEY_MAX_SIZE];
+	auto dit
+	{
+		dbs::room_state_delta.begin(dbs::room_state_delta_key(key_buf, room_id, std::max(base, 0L)))
+	};
+
+	// Without a snapshot the deltas must start at the create event.
+	complete = base >= 0 || (dit && std::get<0>(dbs::room_state_delta_val(dit->second)) == "m.room.create");
+	if(!complete)
+		return;
+
+	for(; dit; ++dit, ++deltas)
+	{
+		const auto &[depth, event_idx]
+		{
+			dbs::room_state_delta_key(dit->first)
+		};
+
+		if(depth >= bound)
+			break;
+
+		const string_view &key
+		{
+			dit->second
+		};
+
+		auto cit(cells.lower_bound(key));
+		if(cit == end(cells) || cit->first != key)
+			cit = cells.emplace_hint(cit, std::string{key}, cell{});
+
+		// The deltas are in the order of (depth, event_idx); the latest wins
+		// as with the state space.
+		cit->second = cell
+		{
+			depth, event_idx, true
+		};
+	}
+}
+
+bool
+ircd::m::room::state::history::snapshot::for_each(const closure &closure)
+const
+{
+	for(const auto &[key, cell] : cells)
+	{
+		const auto &[type, state_key]
+		{
+			dbs::room_state_delta_val(key)
+		};
+
+		if(!closure(type, state_key, cell.depth, cell.event_idx))
+			return false;
+	}
+
+	return true;
+}
+
+/// Stores the reconstruction as a snapshot at the bound. It is a difference
+/// from the keyframe of the snapshot it was built from when possible. The
+/// snapshot is removed again if a state event below the bound may have been
+/// written while it was built, since that write may not have removed it.
+bool
+ircd::m::room::state::history::snapshot::save()
+const try
+{
+	assert(complete);
+	const size_t changed
+	{
+		size_t(std::count_if(begin(cells), end(cells), [](const auto &pair)
+		{
+			return pair.second.changed;
+		}))
+	};
+
+	const bool diff
+	{
+		keyframe >= 0 && changed * 100 <= cells.size() * size_t(snapshot_diff_max)
+	};
+
+	std::vector<dbs::room_state_snapshot_cell> out;
+	out.reserve(diff? changed : cells.size());
+	for(const auto &[key, cell] : cells)
+	{
+		if(diff && !cell.changed)
+			continue;
+
+		const auto &[type, state_key]
+		{
+			dbs::room_state_delta_val(key)
+		};
+
+		out.emplace_back(type, state_key, cell.depth, cell.event_idx);
+	}
+
+	const std::string val
+	{
+		dbs::room_state_snapshot_cells(diff? keyframe : -1L, out)
+	};
+
+	char buf[dbs::ROOM_STATE_SNAPSHOT_KEY_MAX_SIZE];
+	const string_view &key
+	{
+		dbs::room_state_snapshot_key(buf, room_id, bound)
+	};
+
+	db::txn txn
+	{
+		*dbs::events
+	};
+
+	db::txn::append
+	{
+		txn, dbs::room_state_snapshot,
+		{
+			db::op::SET, key, val
+		}
+	};
+
+	txn();
+	if(likely(valid()))
+	{
+		log::debug
+		{
+			log, "Snapshot of %s @%ld %s of @%ld cells:%zu changed:%zu deltas:%zu size:%zu",
+			string_view{room_id},
+			bound,
+			diff? "diff"_sv: "keyframe"_sv,
+			keyframe,
+			cells.size(),
+			changed,
+			deltas,
+			val.size(),
+		};
+
+		return true;
+	}
+
+	db::txn del
+	{
+		*dbs::events
+	};
+
+	db::txn::append
+	{
+		del, dbs::room_state_snapshot,
+		{
+			db::op::DELETE, key
+		}
+	};
+
+	del();
+	return false;
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::derror
+	{
+		log, "Snapshot of %s @%ld :%s",
+		string_view{room_id},
+		bound,
+		e.what(),
+	};
+
+	return false;
+}
+
+/// A state event below the bound is written either with an eval which had
+/// not retired when the deltas were read or which is still in progress.
+bool
+ircd::m::room::state::history::snapshot::valid()
+const
+{
+	const bool pending
+	{
+		!vm::eval::for_each([this](vm::eval &eval)
+		{
+			if(!eval.sequence || eval.sequence <= retired || !eval.event_)
+				return true;
+
+			const auto &event{*eval.event_};
+			return false
+			|| json::get<"room_id"_>(event) != room_id
+			|| json::get<"depth"_>(event) >= bound
+			|| !defined(json::get<"state_key"_>(event))
+			;
+		})
+	};
+
+	if(pending)
+		return false;
+
+	char buf[dbs::ROOM_STATE_DELTA_KEY_MAX_SIZE];
+	auto it
+	{
+		dbs::room_state_delta.begin(dbs::room_state_delta_key(buf, room_id, std::max(base, 0L)))
+	};
+
+	for(; it; ++it)
+	{
+		const auto &[depth, event_idx]
+		{
+			dbs::room_state_delta_key(it->first)
+		};
+
+		if(depth >= bound)
+			break;
+
+		if(event_idx > retired)
+			return false;
+	}
+
+	return true;
+}
+
+bool
+ircd::m::room::state::history::snapshot::apply(const string_view &val,
+                                               const bool &changed)
+{
+	char key_buf[dbs::ROOM_STATE_DELTA_VAL_MAX_SIZE];
+	return dbs::room_state_snapshot_cells(val, [this, &key_buf, &changed]
+	(const string_view &type, const string_view &state_key, const int64_t &depth, const event::idx &event_idx)
+	{
+		const string_view &key
+		{
+			dbs::room_state_delta_val(key_buf, type, state_key)
+		};
+
+		auto it(cells.lower_bound(key));
+		if(it == end(cells) || it->first != key)
+			it = cells.emplace_hint(it, std::string{key}, cell{});
+
+		it->second = cell
+		{
+			depth, event_idx, changed
+		};
+
+		return true;
+	});
+}
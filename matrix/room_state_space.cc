@@ -264,6 +264,7 @@ ircd::m::room::state::space::rebuild::rebuild(const room::id &room_id)
 
 		opts.appendix.reset();
 		opts.appendix.set(dbs::appendix::ROOM_STATE_SPACE);
+		opts.appendix.set(dbs::appendix::ROOM_STATE_DELTA);
 
 		opts.op = pass_static && pass_relative? db::op::SET : db::op::DELETE;
 		state_deleted += opts.op == db::op::DELETE;
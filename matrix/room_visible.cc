@@ -10,14 +10,93 @@
 
 namespace ircd::m
 {
+	struct visible_entry;
+	using visible_lru = std::list<visible_entry>;
+
 	static bool visible_to_node(const room &, const string_view &node_id, const event &);
 	static bool visible_to_user(const room &, const string_view &history_visibility, const m::user::id &, const event &);
+	static string_view visible_cache_key(const mutable_buffer &, const room::id &, const string_view &user_id);
+	static bool visible_cached(const room::id &, const user::id &, const int64_t &depth);
+	static uint64_t &visible_cache_gen(const room::id &);
+	static void visible_cache_erase(const string_view &key);
+	static void visible_invalidate(const event &, vm::eval &);
+
+	extern conf::item<size_t> visible_cache_max;
+	extern std::array<uint64_t, 256> visible_cache_gens;
+	extern visible_lru visible_cache_lru;
+	extern std::map<string_view, visible_lru::iterator, std::less<>> visible_cache;
+	extern hookfn<vm::eval &> visible_member_hook;
+	extern hookfn<vm::eval &> visible_history_hook;
 }
 
+/// The intervals of a (room, user) pair; the key is the room_id and the
+/// user_id separated by a null.
+struct ircd::m::visible_entry
+{
+	std::string key;
+	room::visibility visibility;
+};
+
+decltype(ircd::m::visible_cache_max)
+ircd::m::visible_cache_max
+{
+	{ "name",     "ircd.m.visible.cache.max" },
+	{ "default",  16384L                     },
+	{ "description",
+
+	R"(
+	Maximum number of (room, user) visibility intervals kept in memory. The
+	least recently used entry is evicted when the cache is full.
+	)"},
+};
+
+/// Invalidation counters; rooms are spread over these by hash so a change in
+/// one room doesn't discard results being computed for others.
+decltype(ircd::m::visible_cache_gens)
+ircd::m::visible_cache_gens;
+
+decltype(ircd::m::visible_cache_lru)
+ircd::m::visible_cache_lru;
+
+decltype(ircd::m::visible_cache)
+ircd::m::visible_cache;
+
+decltype(ircd::m::visible_member_hook)
+ircd::m::visible_member_hook
+{
+	visible_invalidate,
+	{
+		{ "_site",  "vm.notify"      },
+		{ "type",   "m.room.member"  },
+	}
+};
+
+decltype(ircd::m::visible_history_hook)
+ircd::m::visible_history_hook
+{
+	visible_invalidate,
+	{
+		{ "_site",  "vm.notify"                  },
+		{ "type",   "m.room.history_visibility"  },
+	}
+};
+
 bool
 ircd::m::visible(const m::event &event,
                  const string_view &mxid)
 {
+	// Users are tested against the intervals of the room when the event has
+	// a depth; member events about the user are always visible to them.
+	if(event.event_id && m::valid(m::id::USER, mxid))
+		if(json::get<"depth"_>(event) != json::undefined_number)
+		{
+			if(json::get<"type"_>(event) == "m.room.member")
+				if(json::get<"state_key"_>(event) == mxid)
+					return true;
+
+			return visible_cached(at<"room_id"_>(event), mxid, at<"depth"_>(event));
+		}
+
 	const m::room room
 	{
 		at<"room_id"_>(event), event.event_id
@@ -147,3 +226,261 @@ ircd::m::visible_to_node(const m::room &room,
 
 	return false;
 }
+
+//
+// cache
+//
+
+bool
+ircd::m::visible_cached(const room::id &room_id,
+                        const user::id &user_id,
+                        const int64_t &depth)
+{
+	char buf[id::MAX_SIZE * 2 + 1];
+	const string_view key
+	{
+		visible_cache_key(buf, room_id, user_id)
+	};
+
+	const auto it
+	{
+		visible_cache.find(key)
+	};
+
+	if(it != end(visible_cache))
+	{
+		visible_cache_lru.splice(begin(visible_cache_lru), visible_cache_lru, it->second);
+		return it->second->visibility(depth);
+	}
+
+	// Computing the intervals yields; an invalidation in the meantime means
+	// the result can't be cached.
+	const auto gen
+	{
+		visible_cache_gen(room_id)
+	};
+
+	room::visibility visibility
+	{
+		room_id, user_id
+	};
+
+	const bool ret
+	{
+		visibility(depth)
+	};
+
+	if(gen != visible_cache_gen(room_id) || !size_t(visible_cache_max))
+		return ret;
+
+	// Another context may have cached the same key while this one yielded.
+	visible_cache_erase(key);
+	while(visible_cache.size() >= size_t(visible_cache_max))
+		visible_cache_erase(visible_cache_lru.back().key);
+
+	visible_cache_lru.emplace_front(visible_entry
+	{
+		std::string{key}, std::move(visibility)
+	});
+
+	visible_cache.emplace(visible_cache_lru.front().key, begin(visible_cache_lru));
+	return ret;
+}
+
+void
+ircd::m::visible_invalidate(const event &event,
+                            vm::eval &eval)
+{
+	const auto &room_id
+	{
+		at<"room_id"_>(event)
+	};
+
+	char buf[id::MAX_SIZE * 2 + 1];
+	++visible_cache_gen(room_id);
+
+	// A member event only affects the user it's about.
+	if(json::get<"type"_>(event) == "m.room.member")
+	{
+		const auto &state_key
+		{
+			at<"state_key"_>(event)
+		};
+
+		visible_cache_erase(visible_cache_key(buf, room_id, state_key));
+		return;
+	}
+
+	const string_view prefix
+	{
+		visible_cache_key(buf, room_id, string_view{})
+	};
+
+	auto it
+	{
+		visible_cache.lower_bound(prefix)
+	};
+
+	while(it != end(visible_cache) && startswith(it->first, prefix))
+	{
+		const auto lit(it->second);
+		it = visible_cache.erase(it);
+		visible_cache_lru.erase(lit);
+	}
+}
+
+void
+ircd::m::visible_cache_erase(const string_view &key)
+{
+	const auto it
+	{
+		visible_cache.find(key)
+	};
+
+	if(it == end(visible_cache))
+		return;
+
+	const auto lit(it->second);
+	visible_cache.erase(it);
+	visible_cache_lru.erase(lit);
+}
+
+uint64_t &
+ircd::m::visible_cache_gen(const room::id &room_id)
+{
+	const size_t pos
+	{
+		std::hash<string_view>{}(room_id) % visible_cache_gens.size()
+	};
+
+	return visible_cache_gens[pos];
+}
+
+ircd::string_view
+ircd::m::visible_cache_key(const mutable_buffer &buf,
+                           const room::id &room_id,
+                           const string_view &user_id)
+{
+	mutable_buffer out{buf};
+	consume(out, copy(out, room_id));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, user_id));
+	return { data(buf), data(out) };
+}
+
+//
+// room::visibility
+//
+
+ircd::m::room::visibility::visibility(const m::room &room,
+                                      const id::user &user_id)
+{
+	const room::state::space space
+	{
+		room
+	};
+
+	// (depth, is_membership, value) of every transition in depth order;
+	// transitions at the same depth are taken in their index order.
+	std::vector<std::tuple<int64_t, bool, std::string>> trans;
+	space.for_each("m.room.member", user_id, [&trans]
+	(const auto &type, const auto &state_key, const auto &depth, const auto &event_idx)
+	{
+		char buf[MEMBERSHIP_MAX_SIZE];
+		trans.emplace_back(depth, true, m::membership(buf, event_idx));
+		return true;
+	});
+
+	space.for_each("m.room.history_visibility", string_view{}, [&trans]
+	(const auto &type, const auto &state_key, const auto &depth, const auto &event_idx)
+	{
+		m::get(std::nothrow, event_idx, "content", [&trans, &depth]
+		(const json::object &content)
+		{
+			const json::string &history_visibility
+			{
+				content.get("history_visibility", "shared")
+			};
+
+			trans.emplace_back(depth, false, history_visibility);
+		});
+
+		return true;
+	});
+
+	std::stable_sort(begin(trans), end(trans), []
+	(const auto &a, const auto &b)
+	{
+		return std::get<int64_t>(a) < std::get<int64_t>(b);
+	});
+
+	// The "shared" visibility depends on the membership at present rather
+	// than at the event.
+	const bool present
+	{
+		m::membership(m::room{room.room_id}, user_id, m::membership_positive)
+	};
+
+	string_view membership, history_visibility
+	{
+		"shared"
+	};
+
+	// Same as visible_to_user() for the state at some depth.
+	const auto allowed{[&]
+	{
+		return false
+		|| history_visibility == "world_readable"
+		|| membership == "join"
+		|| (history_visibility != "joined" && membership == "invite")
+		|| (history_visibility != "joined" && history_visibility != "invited" && present)
+		;
+	}};
+
+	bool open(allowed());
+	int64_t lo(std::numeric_limits<int64_t>::min());
+	for(auto it(begin(trans)); it != end(trans); )
+	{
+		const auto depth
+		{
+			std::get<int64_t>(*it)
+		};
+
+		for(; it != end(trans) && std::get<int64_t>(*it) == depth; ++it)
+		{
+			const auto &[_depth, is_membership, value] {*it};
+			(is_membership? membership: history_visibility) = value;
+		}
+
+		if(allowed() == open)
+			continue;
+
+		// The state changes after the event at this depth, as in
+		// room::state::history.
+		if(open)
+			allow.emplace_back(lo, depth + 1);
+		else
+			lo = depth + 1;
+
+		open = !open;
+	}
+
+	if(open)
+		allow.emplace_back(lo, std::numeric_limits<int64_t>::max());
+}
+
+bool
+ircd::m::room::visibility::operator()(const int64_t &depth)
+const
+{
+	const auto it
+	{
+		std::upper_bound(begin(allow), end(allow), depth, []
+		(const int64_t &depth, const interval &interval)
+		{
+			return depth < interval.first;
+		})
+	};
+
+	return it != begin(allow) && depth < std::prev(it)->second;
+}
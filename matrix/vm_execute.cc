@@ -10,9 +10,13 @@
 
 namespace ircd::m::vm
 {
+	struct phase_scope;
+	using phase_histogram = ircd::stats::item<ircd::stats::histogram>;
+
 	template<class... args> static fault handle_error(const opts &, const fault &, const string_view &fmt, args&&... a);
 	template<class T> static void call_hook(hook::site<T> &, eval &, const event &, T&& data);
 	static size_t calc_txn_reserve(const opts &, const event &);
+	static uint64_t execute_mverify(eval &, const vector_view<const event> &, const uint64_t &, uint64_t &, event::conforms *);
 	static void write_commit(eval &);
 	static void write_append(eval &, const event &);
 	static fault execute_edu(eval &, const event &);
@@ -34,10 +38,96 @@ namespace ircd::m::vm
 	extern hook::site<eval &> notify_hook;       ///< Called to broadcast successful eval
 	extern hook::site<eval &> effect_hook;       ///< Called to apply effects post-notify
 
+	extern conf::item<size_t> mverify_concurrency;
 	extern conf::item<bool> log_commit_debug;
 	extern conf::item<bool> log_accept_debug;
 	extern conf::item<bool> log_accept_info;
+	extern std::array<std::unique_ptr<phase_histogram>, num_of<phase>()> phase_latency;
+}
+
+decltype(ircd::m::vm::mverify_concurrency)
+ircd::m::vm::mverify_concurrency
+{
+	{ "name",     "ircd.m.vm.mverify.concurrency" },
+	{ "default",  4L                              },
+	{ "description",
+
+	R"(
+	Number of offload threads concurrently checking the hashes and signatures
+	of a vector of events before they are evaluated. Zero disables the
+	pre-pass and each event is checked on the IRCd thread during its eval.
+	)"},
+};
+
+/// Enters a phase for the duration of the instance like scope_restore and
+/// records the microseconds spent to that phase's histogram. The time is
+/// inclusive of any nested phase (i.e. EXECUTE covers the whole eval).
+struct ircd::m::vm::phase_scope
+:scope_restore<enum phase>
+{
+	enum phase ours;
+	steady_point started;
+
+	phase_scope(enum phase &, const enum phase &);
+	phase_scope(const phase_scope &) = delete;
+	~phase_scope() noexcept;
+};
+
+ircd::m::vm::phase_scope::phase_scope(enum phase &phase,
+                                      const enum phase &ours)
+:scope_restore<enum vm::phase>
+{
+	phase, vm::phase(ours)
+}
+,ours
+{
+	ours
 }
+,started
+{
+	now<steady_point>()
+}
+{
+}
+
+ircd::m::vm::phase_scope::~phase_scope()
+noexcept
+{
+	const auto elapsed
+	{
+		duration_cast<microseconds>(now<steady_point>() - started)
+	};
+
+	assert(ours < phase_latency.size());
+	if(likely(phase_latency[ours]))
+		(*phase_latency[ours])(elapsed.count());
+}
+
+decltype(ircd::m::vm::phase_latency)
+ircd::m::vm::phase_latency{[]
+{
+	std::decay_t<decltype(phase_latency)> ret;
+	for(size_t i(1); i < ret.size(); ++i)
+	{
+		char buf[2][64];
+		const string_view name
+		{
+			fmt::sprintf
+			{
+				buf[0], "ircd.m.vm.phase.%s.latency",
+				tolower(buf[1], reflect(phase(i))),
+			}
+		};
+
+		ret[i] = std::make_unique<phase_histogram>(json::members
+		{
+			{ "name", name },
+			{ "desc", "Microseconds spent in the phase including nested phases" },
+		});
+	}
+
+	return ret;
+}()};
 
 decltype(ircd::m::vm::log_commit_debug)
 ircd::m::vm::log_commit_debug
@@ -162,11 +252,36 @@ ircd::m::vm::execute(eval &eval,
 		};
 
 		existed += __builtin_popcountl(exists);
+
+		// Verdicts from checking the hashes and signatures of the chunk ahead
+		// of time on the offload threads.
+		uint64_t conformed(0);
+		event::conforms report[64];
+		const uint64_t verified
+		{
+			opts.mverify && opts.phase[phase::VERIFY] && size_t(mverify_concurrency)?
+				execute_mverify(eval, {events.data() + i, j}, exists, conformed, report):
+				0UL
+		};
+
 		for(k = 0; k < j; ++k) try
 		{
-			if(exists & (1 << k))
+			if(exists & (1UL << k))
 				continue;
 
+			const scope_restore eval_conformed
+			{
+				eval.conformed,
+				conformed & (1UL << k)?
+					report + k:
+					nullptr
+			};
+
+			const scope_restore eval_verified
+			{
+				eval.verified, bool(verified & (1UL << k))
+			};
+
 			const auto status
 			{
 				execute(eval, events[i + k])
@@ -202,7 +317,7 @@ try
 		eval::executing
 	};
 
-	const scope_restore eval_phase
+	const phase_scope eval_phase
 	{
 		eval.phase, phase::EXECUTE
 	};
@@ -296,7 +411,7 @@ try
 	// this evaluator might be using different options/credentials.
 	if(likely(opts.phase[phase::DUPCHK] && opts.unique) && event.event_id)
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::DUPCHK
 		};
@@ -410,7 +525,7 @@ try
 	// created event.
 	if(opts.phase[phase::ISSUE] && eval.copts && eval.copts->issue)
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::ISSUE
 		};
@@ -441,7 +556,7 @@ try
 	// include notifying client `/sync` and the federation sender.
 	if(likely(opts.phase[phase::NOTIFY]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::NOTIFY
 		};
@@ -455,7 +570,7 @@ try
 	// notify for the event at issue here has already been made.
 	if(likely(opts.phase[phase::EFFECTS]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::EFFECTS
 		};
@@ -541,7 +656,7 @@ ircd::m::vm::execute_edu(eval &eval,
 {
 	if(likely(eval.opts->phase[phase::EVALUATE]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::EVALUATE
 		};
@@ -551,7 +666,7 @@ ircd::m::vm::execute_edu(eval &eval,
 
 	if(likely(eval.opts->phase[phase::POST]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::POST
 		};
@@ -606,7 +721,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	// composure; these checks only require the event data itself.
 	if(likely(opts.phase[phase::CONFORM]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::CONFORM
 		};
@@ -625,7 +740,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	assert(eval::count(event_id));
 	if(likely(opts.phase[phase::DUPCHK] && opts.unique))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::DUPCHK
 		};
@@ -650,7 +765,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 
 	if(likely(opts.phase[phase::ACCESS]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::ACCESS
 		};
@@ -660,12 +775,12 @@ ircd::m::vm::execute_pdu(eval &eval,
 
 	if(likely(opts.phase[phase::VERIFY]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::VERIFY
 		};
 
-		if(!verify(event))
+		if(!eval.verified && !verify(event))
 			throw m::BAD_SIGNATURE
 			{
 				"Signature verification failed."
@@ -674,7 +789,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 
 	if(likely(opts.phase[phase::FETCH_AUTH] && opts.fetch))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::FETCH_AUTH
 		};
@@ -685,7 +800,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	// Evaluation by auth system; throws
 	if(likely(opts.phase[phase::AUTH_STATIC]) && authenticate)
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::AUTH_STATIC
 		};
@@ -705,7 +820,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 
 	if(likely(opts.phase[phase::FETCH_PREV] && opts.fetch))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::FETCH_PREV
 		};
@@ -715,7 +830,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 
 	if(likely(opts.phase[phase::FETCH_STATE] && opts.fetch))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::FETCH_STATE
 		};
@@ -752,7 +867,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 		&& eval.parent->event_->event_id
 	};
 
-	const scope_restore eval_phase_precommit
+	const phase_scope eval_phase_precommit
 	{
 		eval.phase, phase::PRECOMMIT
 	};
@@ -769,7 +884,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 
 	if(likely(opts.phase[phase::AUTH_RELA] && authenticate))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::AUTH_RELA
 		};
@@ -794,7 +909,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	assert(sequence::retired < sequence::get(eval));
 	sequence::uncommitted = std::max(sequence::get(eval), sequence::uncommitted);
 
-	const scope_restore eval_phase_commit
+	const phase_scope eval_phase_commit
 	{
 		eval.phase, phase::COMMIT
 	};
@@ -811,7 +926,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	// Reevaluation of auth against the present state of the room.
 	if(likely(opts.phase[phase::AUTH_PRES] && authenticate))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::AUTH_PRES
 		};
@@ -822,7 +937,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	// Evaluation by module hooks
 	if(likely(opts.phase[phase::EVALUATE]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::EVALUATE
 		};
@@ -833,7 +948,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	// Allocate transaction; discover shared-sequenced evals.
 	if(likely(opts.phase[phase::INDEX]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::INDEX
 		};
@@ -862,7 +977,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	// an entire eval of several more events recursively before returning.
 	if(likely(opts.phase[phase::POST]))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::POST
 		};
@@ -879,7 +994,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	// Commit the transaction to database iff this eval is at the stack base.
 	if(likely(opts.phase[phase::WRITE] && !parent_post))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::WRITE
 		};
@@ -891,7 +1006,7 @@ ircd::m::vm::execute_pdu(eval &eval,
 	// never return back to that stack base.
 	if(likely(!parent_post))
 	{
-		const scope_restore eval_phase
+		const phase_scope eval_phase
 		{
 			eval.phase, phase::RETIRE
 		};
@@ -1043,6 +1158,10 @@ ircd::m::vm::write_append(eval &eval,
 	};
 }
 
+/// Each eval writes its own transaction. These are not grouped with those of
+/// concurrent evals: AUTH_PRES, EVALUATE and INDEX read the database and must
+/// see every prior eval written, so a group could only form behind the
+/// sequence after INDEX, where the writer already waits on the earlier commits.
 void
 ircd::m::vm::write_commit(eval &eval)
 {
@@ -1075,6 +1194,125 @@ ircd::m::vm::write_commit(eval &eval)
 	#endif
 }
 
+/// Pre-pass over a chunk of at most 64 events to check their hashes and
+/// signatures in parallel on the offload threads. Public keys are resolved
+/// here first; only keys already cached are used to avoid any I/O. Events
+/// set in `skip` are ignored. The conformity report (which includes the hash
+/// check) is written to `report` for each event set in `conformed`. The
+/// return value has a bit set for each event with a good signature; any
+/// event without a positive verdict is simply checked again by its eval.
+uint64_t
+ircd::m::vm::execute_mverify(eval &eval,
+                             const vector_view<const event> &events,
+                             const uint64_t &skip,
+                             uint64_t &conformed,
+                             event::conforms *const report)
+{
+	assert(events.size() <= 64);
+	ed25519::pk pk[64];
+	ed25519::sig sig[64];
+	uint64_t keyed(0);
+	for(size_t i(0); i < events.size(); ++i)
+	{
+		const auto &event
+		{
+			events[i]
+		};
+
+		if((skip & (1UL << i)) || !event.event_id)
+			continue;
+
+		conformed |= (1UL << i);
+		const string_view &origin
+		{
+			json::get<"origin"_>(event)
+		};
+
+		const json::object &origin_sigs
+		{
+			json::get<"signatures"_>(event).get(origin)
+		};
+
+		for(const auto &[key_id, sig_b64] : origin_sigs)
+		{
+			if(!m::keys::cache::has(origin, json::string(key_id)))
+				continue;
+
+			const m::node::keys node_keys
+			{
+				origin
+			};
+
+			const bool found
+			{
+				node_keys.get(json::string(key_id), [&pk, &i]
+				(const ed25519::pk &key)
+				{
+					pk[i] = key;
+				})
+			};
+
+			if(!found)
+				continue;
+
+			sig[i] = ed25519::sig
+			{
+				[&sig_b64](auto &buf)
+				{
+					b64::decode(buf, json::string(sig_b64));
+				}
+			};
+
+			keyed |= (1UL << i);
+			break;
+		}
+	}
+
+	if(!conformed)
+		return 0UL;
+
+	const ctx::ole::opts offload_opts
+	{
+		"vm.mverify",
+		std::min(size_t(mverify_concurrency), size_t(__builtin_popcountl(conformed))),
+	};
+
+	std::atomic<size_t> next {0};
+	std::atomic<uint64_t> verified {0};
+	ctx::offload
+	{
+		offload_opts, [&]
+		{
+			size_t i; while((i = next++) < events.size())
+			{
+				if(~conformed & (1UL << i))
+					continue;
+
+				report[i] = event::conforms
+				{
+					events[i]
+				};
+
+				if(keyed & (1UL << i))
+					if(verify(events[i], pk[i], sig[i]))
+						verified |= (1UL << i);
+			}
+		}
+	};
+
+	log::debug
+	{
+		log, "%s verified %d of %zu events; %d keyed; %d conformed.",
+		loghead(eval),
+		__builtin_popcountl(verified),
+		events.size(),
+		__builtin_popcountl(keyed),
+		__builtin_popcountl(conformed),
+	};
+
+	return verified;
+}
+
 size_t
 ircd::m::vm::calc_txn_reserve(const opts &opts,
                               const event &event)
@@ -10,10 +10,22 @@
 
 namespace ircd::m::search
 {
+	struct result
+	{
+		event::idx event_idx;
+		double rank;
+	};
+
+	constexpr size_t TERMS_MAX {16};
+
+	static double score(const m::event &, const vector_view<const string_view> &, const string_view &keys);
+	static std::vector<event::idx> intersect(const m::room::id &, const vector_view<const string_view> &);
 	static void handle_room_events(client &, const resource::request &, const json::object &, json::stack::object &);
 	static resource::response search_post_handle(client &, const resource::request &);
 	extern resource::method search_post;
 	extern resource search_resource;
+	extern conf::item<size_t> candidates_max;
+	extern conf::item<size_t> limit_max;
 	extern log::log log;
 }
 
@@ -29,6 +41,26 @@ ircd::m::search::log
 	"m.search"
 };
 
+decltype(ircd::m::search::candidates_max)
+ircd::m::search::candidates_max
+{
+	{ "name",     "ircd.m.search.candidates.max" },
+	{ "default",  1024L                          },
+	{ "description",
+
+	R"(
+	Maximum number of indexed events examined for a single query. Events are
+	examined newest first in each room.
+	)"},
+};
+
+decltype(ircd::m::search::limit_max)
+ircd::m::search::limit_max
+{
+	{ "name",     "ircd.m.search.limit.max" },
+	{ "default",  64L                       },
+};
+
 decltype(ircd::m::search::search_resource)
 ircd::m::search::search_resource
 {
@@ -125,31 +157,158 @@ try
 		json::get<"rooms"_>(filter)
 	};
 
+	const auto &keys
+	{
+		json::get<"keys"_>(room_events)
+	};
+
+	const bool recent
+	{
+		json::get<"order_by"_>(room_events) == "recent"
+	};
+
+	const size_t offset
+	{
+		lex_castable<size_t>(request.query["next_batch"])?
+			lex_cast<size_t>(request.query["next_batch"]):
+			0UL
+	};
+
+	const size_t limit
+	{
+		std::clamp
+		(
+			size_t(json::get<"limit"_>(filter, 10L)),
+			1UL,
+			size_t(limit_max)
+		)
+	};
+
 	log::debug
 	{
 		log, "Query '%s' by %s keys:%s order_by:%s inc_state:%b",
 		search_term,
 		string_view{request.user_id},
-		json::get<"keys"_>(room_events),
+		keys,
 		json::get<"order_by"_>(room_events),
 		json::get<"include_state"_>(room_events),
 	};
 
-	json::stack::array results
+	// Reduce the query to the same terms the index was built with.
+	char term_buf[TERMS_MAX][dbs::ROOM_SEARCH_TERM_MAX_SIZE];
+	string_view terms[TERMS_MAX];
+	size_t terms_count(0);
+	{
+		char text_buf[1024];
+		dbs::room_search_terms(json::unescape(text_buf, search_term), [&]
+		(const string_view &term)
+		{
+			terms[terms_count] = string_view
+			{
+				term_buf[terms_count], copy(term_buf[terms_count], term)
+			};
+
+			return ++terms_count < TERMS_MAX;
+		});
+
+		std::sort(terms, terms + terms_count);
+		terms_count = std::distance(terms, std::unique(terms, terms + terms_count));
+	}
+
+	const vector_view<const string_view> query
+	{
+		terms, terms_count
+	};
+
+	std::vector<result> results;
+	size_t candidates(0);
+	m::event::fetch event;
+	const auto for_room{[&](const m::room::id &room_id)
+	{
+		const auto postings
+		{
+			intersect(room_id, query)
+		};
+
+		// Newest events are considered first in case the candidates
+		// run out in a large room.
+		for(auto it(rbegin(postings)); it != rend(postings); ++it)
+		{
+			if(candidates++ >= size_t(candidates_max))
+				return false;
+
+			if(!seek(std::nothrow, event, *it))
+				continue;
+
+			if(!m::match(filter, event))
+				continue;
+
+			if(m::redacted(*it))
+				continue;
+
+			if(!m::visible(event, request.user_id))
+				continue;
+
+			const auto rank
+			{
+				score(event, query, keys)
+			};
+
+			if(rank > 0.0)
+				results.emplace_back(result{*it, rank});
+		}
+
+		return true;
+	}};
+
+	if(terms_count && !empty(rooms))
+	{
+		for(const json::string room_id : rooms)
+			if(valid(m::id::ROOM, room_id) && !for_room(room_id))
+				break;
+	}
+	else if(terms_count)
+	{
+		const m::user::rooms user_rooms
+		{
+			request.user_id
+		};
+
+		user_rooms.for_each(m::user::rooms::closure_bool{[&for_room]
+		(const m::room &room, const string_view &membership)
+		{
+			return for_room(room.room_id);
+		}});
+	}
+
+	std::sort(begin(results), end(results), [&recent]
+	(const auto &a, const auto &b)
+	{
+		if(!recent && a.rank != b.rank)
+			return a.rank > b.rank;
+
+		return a.event_idx > b.event_idx;
+	});
+
+	json::stack::array results_out
 	{
 		room_events_result, "results"
 	};
 
-	long count(0);
+	size_t i(offset);
+	for(; i < results.size() && i < offset + limit; ++i)
 	{
+		if(!seek(std::nothrow, event, results[i].event_idx))
+			continue;
+
 		json::stack::object result
 		{
-			results
+			results_out
 		};
 
 		json::stack::member
 		{
-			result, "rank", json::value(0L)
+			result, "rank", json::value(results[i].rank)
 		};
 
 		json::stack::object result_event
@@ -157,25 +316,49 @@ try
 			result, "result"
 		};
 
-		//m::event::append::opts opts;
-		//m::append(result_event, event, opts);
+		m::event::append::opts opts;
+		opts.event_idx = &results[i].event_idx;
+		opts.user_id = &request.user_id;
+		m::event::append(result_event, event, opts);
 	}
-	results.~array();
+	results_out.~array();
 
 	json::stack::member
 	{
-		room_events_result, "count", json::value(count)
+		room_events_result, "count", json::value(long(results.size()))
 	};
 
-	json::stack::array
+	json::stack::array highlights
 	{
 		room_events_result, "highlights"
 	};
 
+	for(const auto &term : query)
+		highlights.append(term);
+
+	highlights.~array();
+
 	json::stack::object
 	{
 		room_events_result, "state"
 	};
+
+	if(i < results.size())
+		json::stack::member
+		{
+			room_events_result, "next_batch", json::value(lex_cast(i), json::STRING)
+		};
+
+	log::debug
+	{
+		log, "Query '%s' by %s terms:%zu candidates:%zu results:%zu offset:%zu",
+		search_term,
+		string_view{request.user_id},
+		terms_count,
+		candidates,
+		results.size(),
+		offset,
+	};
 }
 catch(const std::system_error &)
 {
@@ -189,3 +372,106 @@ catch(const std::exception &e)
 		e.what()
 	};
 }
+
+/// Intersection of the postings of every term in the room; sorted by
+/// event_idx ascending.
+std::vector<ircd::m::event::idx>
+ircd::m::search::intersect(const m::room::id &room_id,
+                           const vector_view<const string_view> &terms)
+{
+	std::vector<event::idx> ret, next;
+	char key_buf[dbs::ROOM_SEARCH_KEY_MAX_SIZE];
+	for(size_t i(0); i < terms.size(); ++i)
+	{
+		next.clear();
+		const string_view &key
+		{
+			dbs::room_search_key(key_buf, room_id, terms[i])
+		};
+
+		dbs::room_search(key, std::nothrow, [&](const string_view &val)
+		{
+			dbs::room_search_postings(val, [&](const event::idx &idx)
+			{
+				if(!i || std::binary_search(begin(ret), end(ret), idx))
+					next.emplace_back(idx);
+
+				return true;
+			});
+		});
+
+		std::swap(ret, next);
+		if(ret.empty())
+			break;
+	}
+
+	return ret;
+}
+
+/// The postings are a superset of the matches since nothing is removed from
+/// the index. Every term must still be found in one of the selected keys of
+/// the content; the rank is then the proportion of the text which are terms
+/// of the query.
+double
+ircd::m::search::score(const m::event &event,
+                       const vector_view<const string_view> &terms,
+                       const string_view &keys)
+{
+	static const string_view content_keys[]
+	{
+		"body", "name", "topic"
+	};
+
+	const json::object &content
+	{
+		json::get<"content"_>(event)
+	};
+
+	// The keys are given by their full path, e.g. "content.body".
+	const auto selected{[&keys](const string_view &key)
+	{
+		for(const json::string path : json::array(keys))
+			if(startswith(path, "content.") && lstrip(path, "content.") == key)
+				return true;
+
+		return false;
+	}};
+
+	std::bitset<TERMS_MAX> matched;
+	size_t total(0), hits(0);
+	char text_buf[16_KiB];
+	for(const auto &key : content_keys)
+	{
+		if(keys && !selected(key))
+			continue;
+
+		const json::string &value
+		{
+			content.get(key)
+		};
+
+		if(!value)
+			continue;
+
+		dbs::room_search_terms(json::unescape(text_buf, value), [&]
+		(const string_view &term)
+		{
+			const auto it
+			{
+				std::lower_bound(begin(terms), end(terms), term)
+			};
+
+			++total;
+			if(it == end(terms) || *it != term)
+				return true;
+
+			matched.set(std::distance(begin(terms), it));
+			++hits;
+			return true;
+		});
+	}
+
+	return matched.count() == terms.size()?
+		double(hits) / total:
+		0.0;
+}
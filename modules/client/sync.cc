@@ -442,17 +442,81 @@ namespace ircd::m::sync
 
 namespace ircd::m::sync::longpoll
 {
+	struct waiter;
+	using waiters = std::multimap<std::string, waiter *, std::less<>>;
+
 	static bool polled(data &, const args &);
-	static int poll(data &);
+	static int poll(data &, waiter &);
+	static void notify(waiter &, const event::idx &);
+	static size_t route(const string_view &key, const event::idx &);
+	static size_t route_mitsein(const m::user::id &, const event::idx &);
 	static void handle_notify(const m::event &, m::vm::eval &);
 	static void fini() noexcept;
 
 	extern m::hookfn<m::vm::eval &> notified;
-	extern ctx::dock dock;
+	extern std::set<waiter *> deferred;
+	extern std::set<waiter *> all;
+	extern waiters index;
+	extern ircd::stats::item<uint64_t> stats_wakeups;
+	extern ircd::stats::item<uint64_t> stats_spurious;
+	extern ircd::stats::item<uint64_t> stats_skipped;
 }
 
-decltype(ircd::m::sync::longpoll::dock)
-ircd::m::sync::longpoll::dock;
+/// Each longpolling /sync registers one of these under the room_id of every
+/// room its user is joined to, the room_id of the user's own user-room, and
+/// the user_id itself. The vm notification only wakes the waiters found
+/// under the keys an event is routed to; see route().
+///
+/// The waiter keeps the lowest and highest event_idx routed to it since it
+/// last woke. Events outside of that window (and those between which were
+/// not routed) are known to be irrelevant and are skipped by the poller.
+struct ircd::m::sync::longpoll::waiter
+{
+	ctx::dock dock;
+	event::idx next {0};
+	event::idx last {0};
+	bool rejoin {false};
+	std::vector<waiters::iterator> keys;
+
+	void add(const string_view &key);
+	void add(const m::user &);
+	void del() noexcept;
+
+	waiter(const m::user &);
+	waiter(waiter &&) = delete;
+	waiter(const waiter &) = delete;
+	~waiter() noexcept;
+};
+
+decltype(ircd::m::sync::longpoll::stats_wakeups)
+ircd::m::sync::longpoll::stats_wakeups
+{
+	{ "name", "ircd.client.sync.longpoll.wakeups"                          },
+	{ "desc", "Number of longpolling /sync woken by a routed event."       },
+};
+
+decltype(ircd::m::sync::longpoll::stats_spurious)
+ircd::m::sync::longpoll::stats_spurious
+{
+	{ "name", "ircd.client.sync.longpoll.spurious"                         },
+	{ "desc", "Number of longpoll wakeups which produced no output."       },
+};
+
+decltype(ircd::m::sync::longpoll::stats_skipped)
+ircd::m::sync::longpoll::stats_skipped
+{
+	{ "name", "ircd.client.sync.longpoll.skipped"                          },
+	{ "desc", "Number of events never proffered to a longpoll by routing." },
+};
+
+decltype(ircd::m::sync::longpoll::index)
+ircd::m::sync::longpoll::index;
+
+decltype(ircd::m::sync::longpoll::all)
+ircd::m::sync::longpoll::all;
+
+decltype(ircd::m::sync::longpoll::deferred)
+ircd::m::sync::longpoll::deferred;
 
 decltype(ircd::m::sync::longpoll::notified)
 ircd::m::sync::longpoll::notified
@@ -467,14 +531,15 @@ void
 ircd::m::sync::longpoll::fini()
 noexcept
 {
-	if(!dock.empty())
+	if(!all.empty())
 		log::warning
 		{
 			log, "Interrupting %zu longpolling clients...",
-			dock.size(),
+			all.size(),
 		};
 
-	interrupt(dock);
+	for(auto *const &waiter : all)
+		interrupt(waiter->dock);
 }
 
 void
@@ -486,7 +551,63 @@ try
 	if(!eval.opts->notify_clients)
 		return;
 
-	dock.notify_all();
+	const auto &event_idx
+	{
+		vm::sequence::get(eval)
+	};
+
+	// Waiters routed an event which was not yet retired are woken by
+	// whichever notification comes after the retirement.
+	for(auto it(begin(deferred)); it != end(deferred); )
+		if((*it)->next <= vm::sequence::retired)
+		{
+			(*it)->dock.notify_all();
+			it = deferred.erase(it);
+		}
+		else ++it;
+
+	if(all.empty())
+		return;
+
+	const auto &type
+	{
+		json::get<"type"_>(event)
+	};
+
+	const auto &room_id
+	{
+		json::get<"room_id"_>(event)
+	};
+
+	route(room_id, event_idx);
+
+	if(type == "m.room.member")
+		route(json::get<"state_key"_>(event), event_idx);
+
+	// The ephemerals below are all stored in some user's user-room and
+	// are synced to the users of the room they target.
+	if(!startswith(type, "ircd."))
+		return;
+
+	const m::user::id &sender
+	{
+		json::get<"sender"_>(event)
+	};
+
+	if(!m::user::room::is(room_id, sender))
+		return;
+
+	if(type == "ircd.typing")
+		route(json::string(json::get<"content"_>(event).get("room_id")), event_idx);
+
+	else if(type == "ircd.read")
+		route(json::get<"state_key"_>(event), event_idx);
+
+	else if(type == "ircd.presence")
+		route_mitsein(json::string(json::get<"content"_>(event).get("user_id")), event_idx);
+
+	else if(startswith(type, "ircd.device"))
+		route_mitsein(sender, event_idx);
 }
 catch(const ctx::interrupted &)
 {
@@ -502,14 +623,144 @@ catch(const std::exception &e)
 	};
 }
 
+/// Route the event to the waiters of every room the user is joined to.
+size_t
+ircd::m::sync::longpoll::route_mitsein(const m::user::id &user_id,
+                                       const event::idx &event_idx)
+{
+	if(!valid(m::id::USER, user_id))
+		return 0;
+
+	size_t ret(0);
+	const m::user::rooms rooms
+	{
+		user_id
+	};
+
+	rooms.for_each("join", [&ret, &event_idx]
+	(const m::room &room, const string_view &)
+	{
+		ret += route(room.room_id, event_idx);
+	});
+
+	return ret;
+}
+
+size_t
+ircd::m::sync::longpoll::route(const string_view &key,
+                               const event::idx &event_idx)
+{
+	if(!key)
+		return 0;
+
+	size_t ret(0);
+	auto pit(index.equal_range(key));
+	for(; pit.first != pit.second; ++pit.first, ++ret)
+		notify(*pit.first->second, event_idx);
+
+	return ret;
+}
+
+void
+ircd::m::sync::longpoll::notify(waiter &waiter,
+                                const event::idx &event_idx)
+{
+	waiter.next = waiter.next?
+		std::min(waiter.next, event_idx):
+		event_idx;
+
+	waiter.last = std::max(waiter.last, event_idx);
+
+	if(waiter.next > vm::sequence::retired)
+	{
+		deferred.emplace(&waiter);
+		return;
+	}
+
+	waiter.dock.notify_all();
+}
+
+//
+// waiter::waiter
+//
+
+ircd::m::sync::longpoll::waiter::waiter(const m::user &user)
+{
+	const m::user::room user_room
+	{
+		user
+	};
+
+	add(user.user_id);
+	add(user_room.room_id);
+	add(user);
+	all.emplace(this);
+}
+
+ircd::m::sync::longpoll::waiter::~waiter()
+noexcept
+{
+	deferred.erase(this);
+	all.erase(this);
+	del();
+}
+
+void
+ircd::m::sync::longpoll::waiter::add(const m::user &user)
+{
+	const m::user::rooms rooms
+	{
+		user
+	};
+
+	rooms.for_each("join", [this]
+	(const m::room &room, const string_view &)
+	{
+		add(room.room_id);
+	});
+}
+
+void
+ircd::m::sync::longpoll::waiter::add(const string_view &key)
+{
+	keys.emplace_back(index.emplace(std::string(key), this));
+}
+
+void
+ircd::m::sync::longpoll::waiter::del()
+noexcept
+{
+	for(const auto &it : keys)
+		index.erase(it);
+
+	keys.clear();
+}
+
 /// Longpolling blocks the client's request until a relevant event is processed
 /// by the m::vm. If no event is processed by a timeout this returns false.
 bool
 ircd::m::sync::longpoll_handle(data &data)
 try
 {
+	longpoll::waiter waiter
+	{
+		data.user
+	};
+
+	// Events retired before the waiter was registered (i.e. while the linear
+	// or polylog handler was running) were never routed to it; they are
+	// scanned first.
+	if(data.range.second <= vm::sequence::retired)
+	{
+		waiter.next = waiter.next?
+			std::min(waiter.next, data.range.second):
+			data.range.second;
+
+		waiter.last = std::max(waiter.last, vm::sequence::retired);
+	}
+
 	int ret;
-	while((ret = longpoll::poll(data)) == -1)
+	while((ret = longpoll::poll(data, waiter)) == -1)
 	{
 		// When the client explicitly gives a next_batch token we have to
 		// adhere to it and return an empty response before going past their
@@ -521,6 +772,17 @@ try
 
 		++data.range.second;
 		assert(data.range.first <= data.range.second);
+
+		// The user's membership changed; the rooms it's waiting on are
+		// re-indexed. Events already routed to the waiter stay pending.
+		if(waiter.rejoin)
+		{
+			waiter.rejoin = false;
+			waiter.del();
+			waiter.add(data.user.user_id);
+			waiter.add(data.user_room.room_id);
+			waiter.add(data.user);
+		}
 	}
 
 	return ret;
@@ -548,10 +810,11 @@ catch(const std::exception &e)
 	throw;
 }
 
-/// When the vm's sequence number is incremented our dock is notified and the
-/// event at that next sequence number is fetched. That event gets proffered
-/// around the linear sync handlers for whether it's relevant to the user
-/// making the request on this stack.
+/// When an event routed to this waiter is retired the waiter's dock is
+/// notified and the event at that sequence number is fetched. That event gets
+/// proffered around the linear sync handlers for whether it's relevant to the
+/// user making the request on this stack. Events between data.range.second
+/// and the routed event were not routed to this user and are skipped.
 ///
 /// If relevant, we respond immediately with that one event and finish the
 /// request right there, providing them the next since token of one-past the
@@ -571,17 +834,36 @@ catch(const std::exception &e)
 /// has been sent to the client yet here either.
 ///
 int
-ircd::m::sync::longpoll::poll(data &data)
+ircd::m::sync::longpoll::poll(data &data,
+                              waiter &waiter)
 {
-	const auto ready{[&data]
+	const auto ready{[&waiter]
 	{
-		assert(data.range.second <= m::vm::sequence::retired + 1);
-		return data.range.second <= m::vm::sequence::retired;
+		return waiter.next && waiter.next <= m::vm::sequence::retired;
 	}};
 
 	assert(data.args);
-	if(!dock.wait_until(data.args->timesout, ready))
+	if(!waiter.dock.wait_until(data.args->timesout, ready))
+	{
+		// Nothing through the retired sequence was routed here; the client
+		// can resume from there unless it asked for an upper-bound. Anything
+		// routed but not yet scanned is left for the next /sync.
+		const auto resume
+		{
+			waiter.next?
+				std::min(waiter.next, m::vm::sequence::retired + 1):
+				m::vm::sequence::retired + 1
+		};
+
+		if(int64_t(data.args->next_batch) <= 0)
+			if(data.range.second < resume)
+			{
+				stats_skipped += resume - data.range.second;
+				data.range.second = resume;
+			}
+
 		return false;
+	}
 
 	// Check if client went away while we were sleeping,
 	// if so, just returning true is the easiest way out w/o throwing
@@ -594,12 +876,44 @@ ircd::m::sync::longpoll::poll(data &data)
 	const auto &client(*data.client);
 	net::check(*client.sock);
 
+	++stats_wakeups;
+	if(waiter.next > data.range.second)
+	{
+		stats_skipped += waiter.next - data.range.second;
+		data.range.second = waiter.next;
+	}
+
+	// Consume the routed window one event at a time; the caller advances
+	// data.range.second past this event if there's no hit.
+	assert(data.range.second <= m::vm::sequence::retired);
+	waiter.next = data.range.second < waiter.last?
+		data.range.second + 1:
+		0;
+
+	if(!waiter.next)
+		waiter.last = 0;
+
 	// Keep in mind if the handler returns true that means
 	// it made a hit and we can return true to exit longpoll
 	// and end the request cleanly.
 	if(polled(data, *data.args))
 		return true;
 
+	const m::event::fetch::opts fopts
+	{
+		m::event::keys::include {"type", "state_key"}
+	};
+
+	const m::event::fetch event
+	{
+		std::nothrow, data.range.second, fopts
+	};
+
+	if(event.valid)
+		waiter.rejoin |= json::get<"type"_>(event) == "m.room.member" &&
+		                 json::get<"state_key"_>(event) == data.user.user_id;
+
+	++stats_spurious;
 	return -1;
 }
 
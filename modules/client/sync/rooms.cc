@@ -12,6 +12,8 @@ namespace ircd::m::sync
 {
 	static bool should_ignore(const data &);
 
+	static bool _rooms_polylog_room_item(data &, item &);
+	static bool _rooms_polylog_room_cached(data &, item &);
 	static bool _rooms_polylog_room(data &, const m::room &);
 	static bool _rooms_polylog(data &, const string_view &membership, int64_t &phase);
 	static bool rooms_polylog(data &);
@@ -22,10 +24,55 @@ namespace ircd::m::sync
 	extern item rooms;
 }
 
+namespace ircd::m::sync::rooms_cache
+{
+	struct entry;
+	using entries = std::list<entry>;
+	using index = std::map<string_view, entries::iterator, std::less<>>;
+
+	static bool cacheable(const data &, const item &);
+	static event::idx position(const data &);
+	static std::shared_ptr<const std::string> get(const data &, const item &);
+	static std::shared_ptr<const std::string> put(const data &, const item &, std::string);
+	static void erase(index::iterator);
+	static void erase(const string_view &prefix);
+	static void handle_notify(const m::event &, m::vm::eval &);
+
+	extern conf::item<size_t> size;
+	extern conf::item<size_t> fragment_max;
+	extern conf::item<std::string> items;
+	extern ircd::stats::item<uint64_t> stats_hits;
+	extern ircd::stats::item<uint64_t> stats_misses;
+	extern ircd::stats::item<uint64_t> stats_evictions;
+	extern ircd::stats::item<uint64_t> stats_bytes;
+	extern m::hookfn<m::vm::eval &> notified;
+	extern entries lru;
+	extern index map;
+}
+
+/// A serialized room fragment of a polylog /sync (i.e. the value of
+/// rooms.join.!room.state) as it was generated for a user. The fragment is
+/// valid only as long as the room's head and the parameters of the sync
+/// which went into it remain the same.
+struct ircd::m::sync::rooms_cache::entry
+{
+	std::string key;                 // room_id \0 user_id \0 item name
+	event::idx room_head {0};
+	event::idx since {0};
+	size_t filter {0};
+	bool full_state {false};
+	char membership[16] {0};
+	std::shared_ptr<const std::string> value;
+};
+
 ircd::mapi::header
 IRCD_MODULE
 {
-	"Client Sync :Rooms"
+	"Client Sync :Rooms", nullptr, []
+	{
+		ircd::m::sync::rooms_cache::map.clear();
+		ircd::m::sync::rooms_cache::lru.clear();
+	}
 };
 
 decltype(ircd::m::sync::rooms)
@@ -249,30 +296,106 @@ ircd::m::sync::_rooms_polylog_room(data &data,
 	m::sync::for_each("rooms", [&data, &ret]
 	(item &item)
 	{
-		json::stack::checkpoint checkpoint
+		ret |= rooms_cache::cacheable(data, item)?
+			_rooms_polylog_room_cached(data, item):
+			_rooms_polylog_room_item(data, item);
+
+		return true;
+	});
+
+	if(!ret)
+		checkpoint.committing(false);
+
+	return ret;
+}
+
+bool
+ircd::m::sync::_rooms_polylog_room_item(data &data,
+                                        item &item)
+{
+	json::stack::checkpoint checkpoint
+	{
+		*data.out
+	};
+
+	json::stack::object object
+	{
+		*data.out, item.member_name()
+	};
+
+	if(!item.polylog(data))
+	{
+		checkpoint.committing(false);
+		return false;
+	}
+
+	data.out->invalidate_checkpoints();
+	return true;
+}
+
+/// The item is generated into a separate buffer the first time so the
+/// fragment can be kept; if it doesn't fit the item is generated again
+/// into the response and the fragment is remembered as uncacheable.
+bool
+ircd::m::sync::_rooms_polylog_room_cached(data &data,
+                                          item &item)
+{
+	auto value
+	{
+		rooms_cache::get(data, item)
+	};
+
+	if(!value)
+	{
+		const unique_buffer<mutable_buffer> buf
 		{
-			*data.out
+			size_t(rooms_cache::fragment_max)
 		};
 
-		json::stack::object object
+		json::stack out
 		{
-			*data.out, item.member_name()
+			buf
 		};
 
-		if(item.polylog(data))
+		bool ret{false};
 		{
-			ret = true;
-			data.out->invalidate_checkpoints();
+			const scope_restore their_out
+			{
+				data.out, &out
+			};
+
+			json::stack::object object
+			{
+				out
+			};
+
+			ret = item.polylog(data);
 		}
-		else checkpoint.committing(false);
 
-		return true;
-	});
+		value = rooms_cache::put(data, item, out.failed()?
+			std::string{"\0", 1}:
+		ret?
+			std::string{out.completed()}:
+			std::string{});
+	}
 
-	if(!ret)
-		checkpoint.committing(false);
+	assert(value);
+	if(value->size() == 1 && value->front() == '\0')
+		return _rooms_polylog_room_item(data, item);
 
-	return ret;
+	if(value->empty())
+		return false;
+
+	json::stack::member
+	{
+		*data.out, item.member_name(), json::value
+		{
+			*value, json::OBJECT
+		}
+	};
+
+	data.out->invalidate_checkpoints();
+	return true;
 }
 
 bool
@@ -312,3 +435,277 @@ ircd::m::sync::should_ignore(const data &data)
 
 	return ret;
 }
+
+//
+// rooms_cache
+//
+
+decltype(ircd::m::sync::rooms_cache::size)
+ircd::m::sync::rooms_cache::size
+{
+	{ "name",     "ircd.client.sync.rooms.cache.size" },
+	{ "default",  long(64_MiB)                        },
+	{ "description",
+
+	R"(
+	Memory budget for serialized room fragments of polylog /sync responses
+	kept for reuse when the same user syncs the same room at the same head
+	again. Zero disables the cache.
+	)"},
+};
+
+decltype(ircd::m::sync::rooms_cache::fragment_max)
+ircd::m::sync::rooms_cache::fragment_max
+{
+	{ "name",     "ircd.client.sync.rooms.cache.fragment.max" },
+	{ "default",  long(64_KiB)                                },
+	{ "description",
+
+	R"(
+	Largest fragment which will be cached. Items of a room producing more
+	output are generated directly into the response every time.
+	)"},
+};
+
+decltype(ircd::m::sync::rooms_cache::items)
+ircd::m::sync::rooms_cache::items
+{
+	{ "name",     "ircd.client.sync.rooms.cache.items"                       },
+	{ "default",  "rooms.state rooms.summary rooms.unread_notifications"     },
+	{ "description",
+
+	R"(
+	Space separated list of the sync items whose room fragments are cached.
+	The output of these items must be a function of the room's head and the
+	user's membership, filter and since token.
+	)"},
+};
+
+decltype(ircd::m::sync::rooms_cache::stats_hits)
+ircd::m::sync::rooms_cache::stats_hits
+{
+	{ "name", "ircd.client.sync.rooms.cache.hits"                           },
+	{ "desc", "Number of room fragments reused from the cache."             },
+};
+
+decltype(ircd::m::sync::rooms_cache::stats_misses)
+ircd::m::sync::rooms_cache::stats_misses
+{
+	{ "name", "ircd.client.sync.rooms.cache.misses"                         },
+	{ "desc", "Number of cacheable room fragments which had to be generated." },
+};
+
+decltype(ircd::m::sync::rooms_cache::stats_evictions)
+ircd::m::sync::rooms_cache::stats_evictions
+{
+	{ "name", "ircd.client.sync.rooms.cache.evictions"                      },
+	{ "desc", "Number of room fragments dropped for the memory budget."     },
+};
+
+decltype(ircd::m::sync::rooms_cache::stats_bytes)
+ircd::m::sync::rooms_cache::stats_bytes
+{
+	{ "name", "ircd.client.sync.rooms.cache.bytes"                          },
+	{ "desc", "Current size of the cached room fragments."                  },
+};
+
+decltype(ircd::m::sync::rooms_cache::lru)
+ircd::m::sync::rooms_cache::lru;
+
+decltype(ircd::m::sync::rooms_cache::map)
+ircd::m::sync::rooms_cache::map;
+
+decltype(ircd::m::sync::rooms_cache::notified)
+ircd::m::sync::rooms_cache::notified
+{
+	handle_notify,
+	{
+		{ "_site",  "vm.notify" },
+	}
+};
+
+/// Fragments are keyed by the room head so new events in a room make them
+/// unreachable anyway; they're dropped here to return the memory sooner.
+/// Receipts don't move the head, but they change the unread counts.
+void
+ircd::m::sync::rooms_cache::handle_notify(const m::event &event,
+                                          m::vm::eval &eval)
+{
+	if(map.empty())
+		return;
+
+	const auto &room_id
+	{
+		json::get<"room_id"_>(event)
+	};
+
+	const auto &sender
+	{
+		json::get<"sender"_>(event)
+	};
+
+	const bool user_room
+	{
+		m::user::room::is(room_id, sender)
+	};
+
+	if(user_room && json::get<"type"_>(event) != "ircd.read")
+		return;
+
+	thread_local char buf[room::id::MAX_SIZE + 1 + id::MAX_SIZE + 1];
+	mutable_buffer out{buf};
+	consume(out, copy(out, user_room? json::get<"state_key"_>(event): room_id));
+	consume(out, copy(out, '\0'));
+	if(user_room)
+	{
+		consume(out, copy(out, sender));
+		consume(out, copy(out, '\0'));
+	}
+
+	erase(string_view{buf, buffer::data(out)});
+}
+
+void
+ircd::m::sync::rooms_cache::erase(const string_view &prefix)
+{
+	if(!prefix)
+		return;
+
+	auto it(map.lower_bound(prefix));
+	while(it != end(map) && startswith(it->first, prefix))
+		erase(it++);
+}
+
+void
+ircd::m::sync::rooms_cache::erase(index::iterator it)
+{
+	assert(it != end(map));
+	const auto lit(it->second);
+	stats_bytes -= lit->key.size() + lit->value->size() + sizeof(entry);
+	map.erase(it);
+	lru.erase(lit);
+}
+
+std::shared_ptr<const std::string>
+ircd::m::sync::rooms_cache::put(const data &data,
+                                const item &item,
+                                std::string value)
+{
+	std::string key
+	{
+		fmt::snstringf
+		{
+			room::id::MAX_SIZE + 1 + id::MAX_SIZE + 1 + 64, "%s%c%s%c%s",
+			string_view{data.room->room_id},
+			'\0',
+			string_view{data.user.user_id},
+			'\0',
+			item.name(),
+		}
+	};
+
+	const auto it
+	{
+		map.find(key)
+	};
+
+	if(it != end(map))
+		erase(it);
+
+	lru.emplace_front(entry
+	{
+		std::move(key),
+		data.room_head,
+		position(data),
+		std::hash<string_view>{}(data.filter_buf),
+		data.args->full_state,
+		{0},
+		std::make_shared<const std::string>(std::move(value)),
+	});
+
+	auto &entry(lru.front());
+	strlcpy(entry.membership, data.membership);
+	map.emplace(entry.key, begin(lru));
+	stats_bytes += entry.key.size() + entry.value->size() + sizeof(entry);
+
+	while(!lru.empty() && uint64_t(stats_bytes) > size_t(size))
+	{
+		++stats_evictions;
+		erase(map.find(lru.back().key));
+	}
+
+	return entry.value;
+}
+
+std::shared_ptr<const std::string>
+ircd::m::sync::rooms_cache::get(const data &data,
+                                const item &item)
+{
+	char buf[room::id::MAX_SIZE + 1 + id::MAX_SIZE + 1 + 64];
+	const string_view key
+	{
+		fmt::sprintf
+		{
+			buf, "%s%c%s%c%s",
+			string_view{data.room->room_id},
+			'\0',
+			string_view{data.user.user_id},
+			'\0',
+			item.name(),
+		}
+	};
+
+	const auto it
+	{
+		map.find(key)
+	};
+
+	const bool hit
+	{
+		it != end(map)
+		&& it->second->room_head == data.room_head
+		&& it->second->since == position(data)
+		&& it->second->filter == std::hash<string_view>{}(data.filter_buf)
+		&& it->second->full_state == data.args->full_state
+		&& string_view{it->second->membership} == data.membership
+	};
+
+	if(!hit)
+	{
+		++stats_misses;
+		return {};
+	}
+
+	++stats_hits;
+	lru.splice(begin(lru), lru, it->second);
+	return it->second->value;
+}
+
+/// The since token relative to the room: every since token beyond the room's
+/// head selects the same (empty) range of the room's events, so these share
+/// one entry; otherwise an incremental sync would almost never hit.
+ircd::m::event::idx
+ircd::m::sync::rooms_cache::position(const data &data)
+{
+	return std::min(data.range.first, data.room_head + 1);
+}
+
+bool
+ircd::m::sync::rooms_cache::cacheable(const data &data,
+                                      const item &item)
+{
+	if(!size_t(size))
+		return false;
+
+	// Phased sync and prefetching have their own ways.
+	if(data.phased || data.prefetch)
+		return false;
+
+	if(!data.room || !data.room_head || !data.args)
+		return false;
+
+	if(data.membership.size() >= sizeof(entry::membership))
+		return false;
+
+	return token_exists(string_view{items}, ' ', item.name());
+}
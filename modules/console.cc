@@ -10843,6 +10843,53 @@ console_cmd__room__events__horizon__rebuild(opt &out, const string_view &line)
 	return true;
 }
 
+bool
+console_cmd__room__search__rebuild(opt &out, const string_view &line)
+{
+	const params param{line, " ",
+	{
+		"room_id"
+	}};
+
+	const auto &room_id
+	{
+		m::room_id(param.at("room_id"))
+	};
+
+	const m::room room
+	{
+		room_id
+	};
+
+	db::txn txn
+	{
+		*m::dbs::events
+	};
+
+	m::dbs::write_opts wopts;
+	wopts.appendix.reset();
+	wopts.appendix.set(m::dbs::appendix::ROOM_SEARCH);
+
+	// Postings are merged as a set union, so events already indexed are
+	// harmlessly written again.
+	size_t count(0);
+	m::room::events it{room};
+	for(; it; --it)
+	{
+		wopts.event_idx = it.event_idx();
+		m::dbs::write(txn, *it, wopts);
+		if(++count % 8192 == 0)
+		{
+			txn();
+			txn.clear();
+		}
+	}
+
+	txn();
+	out << "done " << count << std::endl;
+	return true;
+}
+
 bool
 console_cmd__room__messages(opt &out, const string_view &line)
 {
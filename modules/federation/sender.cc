@@ -14,17 +14,25 @@ struct unit;
 struct txndata;
 struct txn;
 struct node;
+struct notice;
 
+/// A unit of the outbound queue. PDU's are held by their event_idx only and
+/// fetched from the database when a transaction is built; EDU's have no
+/// index so their JSON is held. One unit is shared by every node it's
+/// queued for.
 struct unit
 :std::enable_shared_from_this<unit>
 {
 	enum type { PDU, EDU, FAILURE };
 
 	enum type type;
+	m::event::idx event_idx {0};
 	std::string s;
+	std::string key;
 
 	unit(std::string s, const enum type &type);
-	unit(const m::event &event);
+	unit(const m::event &event, const m::event::idx &);
+	unit(const m::event::idx &);
 };
 
 struct txndata
@@ -53,10 +61,16 @@ struct txn
 	:txndata{std::move(content)}
 	,send{this->txnid, string_view{this->content}, this->headers, std::move(opts)}
 	,node{&node}
-	,timeout{now<steady_point>()} //TODO: conf
+	,timeout{now<steady_point>()}
 	{}
 };
 
+/// Outbound state for a remote server. The front `inflight` units of the
+/// queue are in the current transaction; they are only removed once the
+/// remote has accepted it. After a failure nothing is sent until `retry`.
+/// The event_idx of the oldest unsent PDU is saved in the node's room while
+/// the remote is behind so the queue can be rebuilt after a restart; the
+/// rebuild scans [restore_pos, restore_end) a chunk at a time.
 struct node
 {
 	std::deque<std::shared_ptr<unit>> q;
@@ -65,35 +79,71 @@ struct node
 	m::node::room room;
 	server::request::opts sopts;
 	txn *curtxn {nullptr};
-
+	size_t inflight {0};
+	size_t failures {0};
+	steady_point retry;
+	m::event::idx since {0};
+	m::event::idx restore_pos {0};
+	m::event::idx restore_end {0};
+	std::map<std::string, bool, std::less<>> restore_rooms;
+	bool dropped {false};
+	std::unique_ptr<ircd::stats::item<uint64_t>> depth;
+
+	bool restoring() const;
+	m::event::idx oldest() const;
+	void save(const m::event::idx &);
+	void success();
+	void failure();
 	bool flush();
 	void push(std::shared_ptr<unit>);
 
-	node(const string_view &remote)
-	:remote{ircd::strlcpy{mutable_buffer{rembuf}, remote}}
-	,room{this->remote}
-	{}
+	node(const string_view &remote);
+};
+
+struct notice
+{
+	std::string event;
+	m::event::id::buf event_id;
+	m::event::idx event_idx;
 };
 
 std::list<txn> txns;
 std::map<std::string, node, std::less<>> nodes;
 
+static node &get_node(const string_view &remote);
 void remove_node(const node &);
 static void recv_timeout(txn &, node &);
 static void recv_timeouts();
 static bool recv_handle(txn &, node &);
 static void recv();
+static void recv_retry();
 static void recv_worker();
 ctx::dock recv_action;
 
-static void send_from_user(const m::event &, const m::user::id &user_id);
-static void send_to_user(const m::event &, const m::user::id &user_id);
-static void send_to_room(const m::event &, const m::room::id &room_id);
-static void send(const m::event &);
+static void send_from_user(const m::event &, const m::user::id &user_id, const m::event::idx &);
+static void send_to_user(const m::event &, const m::user::id &user_id, const m::event::idx &);
+static void send_to_room(const m::event &, const m::room::id &room_id, const m::event::idx &);
+static void send(const m::event &, const m::event::idx &);
 static void send_worker();
 
+static bool restore(node &);
+static bool restore();
+static void save();
+
 static void handle_notify(const m::event &, m::vm::eval &);
 
+extern conf::item<size_t> txn_pdus_max;
+extern conf::item<size_t> txn_edus_max;
+extern conf::item<seconds> txn_timeout;
+extern conf::item<size_t> queue_max;
+extern conf::item<size_t> restore_chunk;
+extern conf::item<seconds> backoff_min;
+extern conf::item<seconds> backoff_max;
+extern ircd::stats::item<uint64_t> stats_coalesced;
+extern ircd::stats::item<uint64_t> stats_dropped;
+extern ircd::stats::item<uint64_t> stats_failures;
+extern size_t restoring;
+
 context
 sender
 {
@@ -106,12 +156,14 @@ receiver
 	"m.fedsnd.R", 1_MiB, &recv_worker, context::POST,
 };
 
+
 mapi::header
 IRCD_MODULE
 {
 	"federation sender", nullptr,
 	[]
 	{
+		save();
 		sender.terminate();
 		receiver.terminate();
 		sender.join();
@@ -119,9 +171,100 @@ IRCD_MODULE
 	}
 };
 
-std::deque<std::pair<std::string, m::event::id::buf>>
+conf::item<size_t>
+txn_pdus_max
+{
+	{ "name",     "ircd.federation.sender.txn.pdus.max" },
+	{ "default",  50L                                   },
+};
+
+conf::item<size_t>
+txn_edus_max
+{
+	{ "name",     "ircd.federation.sender.txn.edus.max" },
+	{ "default",  100L                                  },
+};
+
+conf::item<seconds>
+txn_timeout
+{
+	{ "name",     "ircd.federation.sender.txn.timeout" },
+	{ "default",  45L                                  },
+};
+
+conf::item<size_t>
+queue_max
+{
+	{ "name",     "ircd.federation.sender.queue.max" },
+	{ "default",  8192L                              },
+	{ "description",
+
+	R"(
+	Maximum number of units queued for a remote server. When a remote is
+	unreachable the oldest are dropped past this limit; the remote can still
+	obtain dropped PDU's through prev_events.
+	)"},
+};
+
+conf::item<size_t>
+restore_chunk
+{
+	{ "name",     "ircd.federation.sender.restore.chunk" },
+	{ "default",  4096L                                  },
+	{ "description",
+
+	R"(
+	Number of events scanned at a time when rebuilding the queue of a remote
+	after a restart. New events are routed between the chunks.
+	)"},
+};
+
+conf::item<seconds>
+backoff_min
+{
+	{ "name",     "ircd.federation.sender.backoff.min" },
+	{ "default",  10L                                  },
+};
+
+conf::item<seconds>
+backoff_max
+{
+	{ "name",     "ircd.federation.sender.backoff.max" },
+	{ "default",  long(60 * 60)                        },
+	{ "description",
+
+	R"(
+	After a failed transaction nothing more is sent to the remote until the
+	backoff elapses; it begins at the min and doubles with each consecutive
+	failure up to this max.
+	)"},
+};
+
+decltype(stats_coalesced)
+stats_coalesced
+{
+	{ "name", "ircd.federation.sender.coalesced" },
+};
+
+decltype(stats_dropped)
+stats_dropped
+{
+	{ "name", "ircd.federation.sender.dropped" },
+};
+
+decltype(stats_failures)
+stats_failures
+{
+	{ "name", "ircd.federation.sender.failures" },
+};
+
+std::deque<notice>
 notified_queue;
 
+/// Number of nodes with a queue still being restored.
+size_t
+restoring;
+
 ctx::dock
 notified_dock;
 
@@ -153,7 +296,20 @@ try
 			m::event::id::buf{}
 	};
 
-	notified_queue.emplace_back(json::strung{event}, event_id);
+	// PDU's are queued by their index; the JSON here is only held until the
+	// event is routed by the sender context.
+	const m::event::idx &event_idx
+	{
+		event.event_id?
+			eval.sequence:
+			0UL
+	};
+
+	notified_queue.emplace_back(notice
+	{
+		json::strung{event}, event_id, event_idx
+	});
+
 	notified_dock.notify_all();
 }
 catch(const ctx::interrupted &)
@@ -173,20 +329,28 @@ void
 __attribute__((noreturn))
 send_worker()
 {
+	restore();
 	while(1) try
 	{
 		notified_dock.wait([]
 		{
-			return !notified_queue.empty();
+			return !notified_queue.empty() || restoring;
 		});
 
+		// One chunk of a pending restore between each routed event.
+		if(restoring)
+			restore();
+
+		if(notified_queue.empty())
+			continue;
+
 		const unwind pop{[]
 		{
 			assert(!notified_queue.empty());
 			notified_queue.pop_front();
 		}};
 
-		const auto &[event_, event_id]
+		const auto &[event_, event_id, event_idx]
 		{
 			notified_queue.front()
 		};
@@ -196,7 +360,7 @@ send_worker()
 			json::object{event_}, event_id
 		};
 
-		send(event);
+		send(event, event_idx);
 	}
 	catch(const std::exception &e)
 	{
@@ -208,7 +372,8 @@ send_worker()
 }
 
 void
-send(const m::event &event)
+send(const m::event &event,
+     const m::event::idx &event_idx)
 {
 	const auto &type
 	{
@@ -235,7 +400,7 @@ send(const m::event &event)
 
 	// target is every remote server in a room
 	if(valid(m::id::ROOM, room_id))
-		return send_to_room(event, m::room::id{room_id});
+		return send_to_room(event, m::room::id{room_id}, event_idx);
 
 	// target is remote server hosting user/device
 	if(type == "m.direct_to_device")
@@ -246,18 +411,19 @@ send(const m::event &event)
 		};
 
 		if(valid(m::id::USER, target))
-			return send_to_user(event, m::user::id(target));
+			return send_to_user(event, m::user::id(target), event_idx);
 	}
 
 	// target is every remote server from every room a user is joined to.
 	if(valid(m::id::USER, sender))
-		return send_from_user(event, m::user::id{sender});
+		return send_from_user(event, m::user::id{sender}, event_idx);
 }
 
 /// EDU and PDU path where the target is a room
 void
 send_to_room(const m::event &event,
-             const m::room::id &room_id)
+             const m::room::id &room_id,
+             const m::event::idx &event_idx)
 {
 	const m::room room
 	{
@@ -271,7 +437,7 @@ send_to_room(const m::event &event,
 
 	// Unit is not allocated until we find another server in the room.
 	std::shared_ptr<struct unit> unit;
-	const auto each_origin{[&unit, &event]
+	const auto each_origin{[&unit, &event, &event_idx]
 	(const string_view &origin)
 	{
 		if(my_host(origin))
@@ -280,29 +446,50 @@ send_to_room(const m::event &event,
 		if(m::fed::errant(origin))
 			return;
 
-		auto it
+		// One remote failing must not keep the unit from the others.
+		try
 		{
-			nodes.lower_bound(origin)
-		};
+			auto &node
+			{
+				get_node(origin)
+			};
 
-		if(it == end(nodes) || it->first != origin)
-			it = nodes.emplace_hint(it, origin, origin);
+			if(!unit)
+				unit = std::make_shared<struct unit>(event, event_idx);
 
-		auto &node
+			node.push(unit);
+			node.flush();
+		}
+		catch(const ctx::interrupted &)
 		{
-			it->second
-		};
-
-		if(!unit)
-			unit = std::make_shared<struct unit>(event);
-
-		node.push(unit);
-		node.flush();
+			throw;
+		}
+		catch(const std::exception &e)
+		{
+			log::error
+			{
+				m::log, "Federation sender failed to queue %s for '%s' :%s",
+				string_view{event.event_id},
+				origin,
+				e.what(),
+			};
+		}
 	}};
 
 	// Iterate all servers with a joined user
 	origins.for_each(each_origin);
 
+	// While the state of the room is partial, the servers reported at the
+	// join which aren't in the state we hold yet.
+	m::room::state::partial_servers(room_id, [&origins, &each_origin]
+	(const string_view &origin)
+	{
+		if(!origins.has(origin))
+			each_origin(origin);
+
+		return true;
+	});
+
 	// Special case for negative membership changes (i.e kicks and bans)
 	// which may remove a server from the above iteration
 	if(json::get<"type"_>(event) == "m.room.member")
@@ -326,7 +513,8 @@ send_to_room(const m::event &event,
 /// EDU path where the target is a user/device
 void
 send_to_user(const m::event &event,
-             const m::user::id &user_id)
+             const m::user::id &user_id,
+             const m::event::idx &event_idx)
 {
 	const string_view &origin
 	{
@@ -339,22 +527,14 @@ send_to_user(const m::event &event,
 	if(m::fed::errant(origin))
 		return;
 
-	auto it
-	{
-		nodes.lower_bound(origin)
-	};
-
-	if(it == end(nodes) || it->first != origin)
-		it = nodes.emplace_hint(it, origin, origin);
-
 	auto &node
 	{
-		it->second
+		get_node(origin)
 	};
 
 	auto unit
 	{
-		std::make_shared<struct unit>(event)
+		std::make_shared<struct unit>(event, event_idx)
 	};
 
 	node.push(std::move(unit));
@@ -365,15 +545,17 @@ send_to_user(const m::event &event,
 /// is joined to.
 void
 send_from_user(const m::event &event,
-               const m::user::id &user_id)
+               const m::user::id &user_id,
+               const m::event::idx &event_idx)
 {
 	const m::user::servers servers
 	{
 		user_id
 	};
 
-	// Iterate all of the servers visible in this user's joined rooms.
-	servers.for_each("join", [&user_id, &event]
+	// Unit is not allocated until we find another server.
+	std::shared_ptr<struct unit> unit;
+	servers.for_each("join", [&unit, &event, &event_idx]
 	(const string_view &origin)
 	{
 		if(my_host(origin))
@@ -382,36 +564,318 @@ send_from_user(const m::event &event,
 		if(m::fed::errant(origin))
 			return true;
 
-		auto it
+		auto &node
 		{
-			nodes.lower_bound(origin)
+			get_node(origin)
 		};
 
-		if(it == end(nodes) || it->first != origin)
-			it = nodes.emplace_hint(it, origin, origin);
+		if(!unit)
+			unit = std::make_shared<struct unit>(event, event_idx);
 
-		auto &node
+		node.push(unit);
+		node.flush();
+		return true;
+	});
+}
+
+//
+// persistence
+//
+
+/// Finds each remote which was behind when the server last stopped; the
+/// position is the current state of the node's room. The first call only
+/// records the range of events to scan for each; later calls scan one chunk
+/// of one remote. Returns false when there's nothing left to restore.
+bool
+restore()
+try
+{
+	static bool started;
+	if(started)
+	{
+		for(auto &[remote, node] : nodes)
+			if(node.restoring())
+				return restore(node);
+
+		assert(!restoring);
+		return false;
+	}
+
+	started = true;
+	m::events::type::for_each_in("ircd.federation.sender", []
+	(const string_view &type, const m::event::idx &event_idx)
+	{
+		const m::event::fetch event
 		{
-			it->second
+			std::nothrow, event_idx
 		};
 
-		auto unit
+		if(!event.valid)
+			return true;
+
+		const m::room::state state
 		{
-			std::make_shared<struct unit>(event)
+			m::room::id{at<"room_id"_>(event)}
 		};
 
-		node.push(unit);
-		node.flush();
+		if(state.get(std::nothrow, type, string_view{}) != event_idx)
+			return true;
+
+		const json::object &content
+		{
+			json::get<"content"_>(event)
+		};
+
+		const json::string remote
+		{
+			content["remote"]
+		};
+
+		const auto since
+		{
+			content.get<m::event::idx>("since", 0UL)
+		};
+
+		if(!remote || !since)
+			return true;
+
+		// Events after this are routed by the notify hook.
+		auto &node(get_node(remote));
+		const bool already(node.restoring());
+		node.since = since;
+		node.restore_pos = since;
+		node.restore_end = m::vm::sequence::retired + 1;
+		restoring += !already && node.restoring();
 		return true;
 	});
+
+	return restoring;
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		m::log, "Federation sender failed to restore queues :%s",
+		e.what(),
+	};
+
+	for(auto &[remote, node] : nodes)
+		node.restore_pos = node.restore_end;
+
+	restoring = 0;
+	return false;
+}
+
+/// Queues our PDU's of the next chunk in each room shared with the remote.
+/// Only the newest are kept when there are more than the queue allows.
+bool
+restore(node &node)
+{
+	static const m::event::fetch::opts fopts
+	{
+		m::event::keys::include
+		{
+			"origin", "room_id", "sender",
+		}
+	};
+
+	assert(node.restoring());
+	const m::event::idx stop
+	{
+		std::min(node.restore_pos + size_t(restore_chunk), node.restore_end)
+	};
+
+	m::events::for_each({node.restore_pos, stop, &fopts}, [&node]
+	(const m::event::idx &event_idx, const m::event &event)
+	{
+		if(!my(event))
+			return true;
+
+		const auto &room_id
+		{
+			json::get<"room_id"_>(event)
+		};
+
+		if(!valid(m::id::ROOM, room_id))
+			return true;
+
+		auto &shared
+		{
+			node.restore_rooms
+		};
+
+		auto it
+		{
+			shared.lower_bound(room_id)
+		};
+
+		if(it == end(shared) || it->first != room_id)
+			it = shared.emplace_hint(it, room_id, m::room::origins
+			{
+				m::room{m::room::id{room_id}}
+			}.has(node.remote));
+
+		if(it->second)
+			node.push(std::make_shared<unit>(event_idx));
+
+		return true;
+	});
+
+	node.restore_pos = stop;
+	if(!node.restoring())
+	{
+		--restoring;
+		node.restore_rooms.clear();
+		log::info
+		{
+			m::log, "Federation sender restored %zu units for '%s' since %lu%s",
+			node.q.size(),
+			node.remote,
+			node.since,
+			node.dropped?
+				" (oldest dropped)"_sv:
+				string_view{},
+		};
+	}
+
+	node.flush();
+	return true;
+}
+
+/// Saves the position of every remote which has PDU's still queued.
+void
+save()
+{
+	for(auto &[remote, node] : nodes)
+		if(!node.since)
+			node.save(node.oldest());
+}
+
+//
+// node
+//
+
+static string_view
+make_depth_name(const string_view &remote)
+{
+	thread_local char buf[128];
+	mutable_buffer out{buf, sizeof(buf) - 1};
+	consume(out, copy(out, "ircd.federation.sender.queue."_sv));
+	const string_view name
+	{
+		buf, size_t(std::distance(buf, data(out) + copy(out, remote)))
+	};
+
+	// Host characters which can't appear in a metric name.
+	std::replace_if(buf, buf + size(name), [](const char &c)
+	{
+		return c == '-' || c == '[' || c == ']';
+	}, '_');
+
+	return name;
+}
+
+/// The name can collide when remotes differ only past the length limit or
+/// in characters which are replaced; the second of those isn't reported.
+static std::unique_ptr<ircd::stats::item<uint64_t>>
+make_depth(const string_view &remote)
+try
+{
+	return std::make_unique<ircd::stats::item<uint64_t>>(json::members
+	{
+		{ "name", make_depth_name(remote) },
+	});
+}
+catch(const std::exception &e)
+{
+	log::dwarning
+	{
+		m::log, "Federation sender queue depth for '%s' not reported :%s",
+		remote,
+		e.what(),
+	};
+
+	return {};
+}
+
+node &
+get_node(const string_view &remote)
+{
+	auto it
+	{
+		nodes.lower_bound(remote)
+	};
+
+	if(it == end(nodes) || it->first != remote)
+		it = nodes.emplace_hint(it, remote, remote);
+
+	return it->second;
+}
+
+node::node(const string_view &remote)
+:remote
+{
+	ircd::strlcpy{mutable_buffer{rembuf}, remote}
+}
+,room
+{
+	this->remote
+}
+,depth
+{
+	make_depth(this->remote)
+}
+{
 }
 
 void
 node::push(std::shared_ptr<unit> su)
 {
+	// An EDU superseded by this one is replaced in place unless it is
+	// already in the transaction.
+	if(!su->key.empty())
+	{
+		const auto it
+		{
+			std::find_if(begin(q) + inflight, end(q), [&su]
+			(const auto &unit)
+			{
+				return unit->key == su->key;
+			})
+		};
+
+		if(it != end(q))
+		{
+			*it = std::move(su);
+			++stats_coalesced;
+			return;
+		}
+	}
+
+	// The oldest units not in the transaction make way for new ones.
+	if(q.size() >= size_t(queue_max) && q.size() > inflight)
+	{
+		const auto it
+		{
+			begin(q) + inflight
+		};
+
+		dropped |= (*it)->type == unit::PDU;
+		q.erase(it);
+		++stats_dropped;
+	}
+
 	q.emplace_back(std::move(su));
+	if(depth)
+		depth->val = q.size();
 }
 
+/// Builds a transaction from the front of the queue up to the PDU and EDU
+/// limits. PDU's are fetched from the database here.
 bool
 node::flush()
 try
@@ -422,60 +886,93 @@ try
 	if(curtxn)
 		return true;
 
-	size_t pdus{0}, edus{0};
-	for(const auto &unit : q) switch(unit->type)
-	{
-		case unit::PDU:   ++pdus;  break;
-		case unit::EDU:   ++edus;  break;
-		default:                   break;
-	}
+	if(failures && now<steady_point>() < retry)
+		return true;
 
-	size_t pc(0), ec(0);
-	std::vector<json::value> units(pdus + edus);
-	for(const auto &unit : q) switch(unit->type)
+	const size_t pdus_max(txn_pdus_max), edus_max(txn_edus_max);
+	std::vector<std::string> pdus;
+	std::vector<json::value> edus;
+	size_t count(0);
+	for(; count < q.size(); ++count)
 	{
-		case unit::PDU:
-			units.at(pc++) = string_view{unit->s};
-			break;
+		const auto &unit
+		{
+			*q.at(count)
+		};
 
-		case unit::EDU:
-			units.at(pdus + ec++) = string_view{unit->s};
+		if(unit.type == unit::PDU && pdus.size() >= pdus_max)
 			break;
 
-		default:
+		if(unit.type == unit::EDU && edus.size() >= edus_max)
 			break;
-	}
 
-	m::fed::send::opts opts;
-	opts.remote = remote;
-	opts.sopts = &sopts;
+		switch(unit.type)
+		{
+			case unit::PDU:
+			{
+				const m::event::fetch event
+				{
+					std::nothrow, unit.event_idx
+				};
+
+				if(!event.valid)
+				{
+					log::dwarning
+					{
+						m::log, "Federation sender to '%s' dropping unfetchable PDU idx:%lu",
+						remote,
+						unit.event_idx,
+					};
+
+					continue;
+				}
+
+				pdus.emplace_back(json::strung{event});
+				continue;
+			}
+
+			case unit::EDU:
+				edus.emplace_back(string_view{unit.s});
+				continue;
+
+			default:
+				continue;
+		}
+	}
 
-	const vector_view<const json::value> pduv
+	if(pdus.empty() && edus.empty())
 	{
-		units.data(), units.data() + pc
-	};
+		q.erase(begin(q), begin(q) + count);
+		if(depth)
+			depth->val = q.size();
+		return true;
+	}
 
-	const vector_view<const json::value> eduv
-	{
-		units.data() + pdus, units.data() + pdus + ec
-	};
+	const std::vector<json::value> pduv
+	(
+		begin(pdus), end(pdus)
+	);
 
+	m::fed::send::opts opts;
+	opts.remote = remote;
+	opts.sopts = &sopts;
 	std::string content
 	{
-		m::txn::create(pduv, eduv)
+		m::txn::create(pduv, edus)
 	};
 
 	txns.emplace_back(*this, std::move(content), std::move(opts));
 	const unwind_nominal_assertion na;
 	curtxn = &txns.back();
-	q.clear();
+	inflight = count;
 	log::debug
 	{
-		m::log, "sending txn %s pdus:%zu edus:%zu to '%s'",
+		m::log, "sending txn %s pdus:%zu edus:%zu to '%s' queued:%zu",
 		curtxn->txnid,
-		pdus,
-		edus,
+		pdus.size(),
+		edus.size(),
 		this->remote,
+		q.size() - inflight,
 	};
 
 	recv_action.notify_one();
@@ -491,19 +988,135 @@ catch(const std::exception &e)
 	return false;
 }
 
+void
+node::success()
+{
+	assert(inflight <= q.size());
+	q.erase(begin(q), begin(q) + inflight);
+	inflight = 0;
+	if(depth)
+		depth->val = q.size();
+
+	if(failures)
+		log::info
+		{
+			m::log, "Federation sender to '%s' recovered after %zu failures; %zu units queued%s",
+			remote,
+			failures,
+			q.size(),
+			dropped?
+				" (oldest dropped)"_sv:
+				string_view{},
+		};
+
+	failures = 0;
+	retry = steady_point{};
+	dropped = false;
+
+	// The position is cleared once the remote has caught up.
+	if(since && !restoring() && !oldest())
+		save(0);
+}
+
+void
+node::failure()
+{
+	inflight = 0;
+	const auto backoff
+	{
+		std::min(seconds(backoff_min) * (1L << std::min(failures, 20UL)), seconds(backoff_max))
+	};
+
+	++failures;
+	++stats_failures;
+	retry = now<steady_point>() + backoff;
+	log::dwarning
+	{
+		m::log, "Federation sender to '%s' failed %zu times; retry in %ld seconds with %zu units queued",
+		remote,
+		failures,
+		backoff.count(),
+		q.size(),
+	};
+
+	if(!since)
+		save(oldest());
+}
+
+void
+node::save(const m::event::idx &since)
+try
+{
+	if(this->since == since)
+		return;
+
+	if(!exists(room.node))
+		m::create(room.node);
+
+	m::send(room, m::me(), "ircd.federation.sender", "", json::members
+	{
+		{ "remote",  remote       },
+		{ "since",   long(since)  },
+	});
+
+	this->since = since;
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
+	{
+		m::log, "Federation sender failed to save position for '%s' :%s",
+		remote,
+		e.what(),
+	};
+}
+
+m::event::idx
+node::oldest()
+const
+{
+	// Restored units are queued behind those routed since startup.
+	m::event::idx ret(0);
+	for(const auto &unit : q)
+		if(unit->type == unit::PDU)
+			ret = ret? std::min(ret, unit->event_idx): unit->event_idx;
+
+	return ret;
+}
+
+bool
+node::restoring()
+const
+{
+	return restore_pos < restore_end;
+}
+
+//
+// recv
+//
+
 void
 __attribute__((noreturn))
 recv_worker()
 {
 	while(1)
 	{
-		recv_action.wait([]
+		recv_action.wait_for(seconds(5), []
 		{
 			return !txns.empty();
 		});
 
-		recv();
-		recv_timeouts();
+		if(!txns.empty())
+		{
+			recv();
+			recv_timeouts();
+		}
+
+		recv_retry();
 	}
 }
 
@@ -545,8 +1158,10 @@ try
 	node.curtxn = nullptr;
 	txns.erase(it);
 
-	if(!ret)
-		return;
+	if(ret)
+		node.success();
+	else
+		node.failure();
 
 	node.flush();
 }
@@ -559,6 +1174,32 @@ catch(const std::exception &e)
 	};
 }
 
+/// Flushes the remotes whose backoff has elapsed.
+void
+recv_retry()
+{
+	static steady_point next;
+	const auto now
+	{
+		ircd::now<steady_point>()
+	};
+
+	if(now < next)
+		return;
+
+	next = now + seconds(backoff_min);
+	for(auto &[remote, node] : nodes)
+	{
+		if(!node.failures || node.curtxn)
+			continue;
+
+		if(node.retry <= now)
+			node.flush();
+		else
+			next = std::min(next, node.retry);
+	}
+}
+
 bool
 recv_handle(txn &txn,
             node &node)
@@ -646,7 +1287,7 @@ recv_timeouts()
 	{
 		auto &txn(*it);
 		assert(txn.node);
-		if(txn.timeout + seconds(45) < now) //TODO: conf
+		if(txn.timeout + seconds(txn_timeout) < now)
 			recv_timeout(txn, *txn.node);
 	}
 }
@@ -681,30 +1322,106 @@ remove_node(const node &node)
 // unit
 //
 
-unit::unit(const m::event &event)
+/// EDU's of these types supersede an earlier one of the same type for the
+/// same user and room. The EDU's carry no sender; the user is found in the
+/// content. Receipts and presence are only coalesced when they are for a
+/// single user. Others (i.e. to-device messages and device list updates) are
+/// never coalesced.
+static std::string
+make_key(const m::event &event)
+{
+	const auto &type
+	{
+		json::get<"type"_>(event)
+	};
+
+	const json::object &content
+	{
+		json::get<"content"_>(event)
+	};
+
+	string_view user_id, room_id;
+	if(type == "m.typing")
+	{
+		user_id = json::string{content["user_id"]};
+		room_id = json::string{content["room_id"]};
+	}
+	else if(type == "m.receipt" && content.size() == 1)
+	{
+		// room_id => { m.read => { user_id => receipt } }
+		const auto &[room_id_, receipts] {*begin(content)};
+		const json::object &read
+		{
+			json::object{receipts}["m.read"]
+		};
+
+		room_id = room_id_;
+		if(json::object{receipts}.size() == 1 && read.size() == 1)
+			user_id = begin(read)->first;
+	}
+	else if(type == "m.presence")
+	{
+		const json::array &push
+		{
+			content["push"]
+		};
+
+		if(push.size() == 1)
+			user_id = json::string{json::object{push.at(0)}["user_id"]};
+	}
+
+	if(!user_id)
+		return {};
+
+	return fmt::snstringf
+	{
+		512, "%s %s %s",
+		type,
+		user_id,
+		room_id,
+	};
+}
+
+unit::unit(const m::event &event,
+           const m::event::idx &event_idx)
 :type
 {
-	event.event_id? PDU: EDU
+	event_idx? PDU: EDU
+}
+,event_idx
+{
+	event_idx
 }
 ,s{[this, &event]
 () -> std::string
 {
-	switch(this->type)
-	{
-		case PDU:
-			return json::strung{event};
-
-		case EDU:
-			return json::strung{json::members
-			{
-				{ "content",   json::get<"content"_>(event)  },
-				{ "edu_type",  json::get<"type"_>(event)     },
-			}};
+	if(this->type != EDU)
+		return {};
 
-		default:
-			return {};
-	}
+	return json::strung{json::members
+	{
+		{ "content",   json::get<"content"_>(event)  },
+		{ "edu_type",  json::get<"type"_>(event)     },
+	}};
 }()}
+,key
+{
+	this->type == EDU?
+		make_key(event):
+		std::string{}
+}
+{
+}
+
+unit::unit(const m::event::idx &event_idx)
+:type
+{
+	PDU
+}
+,event_idx
+{
+	event_idx
+}
 {
 }
 
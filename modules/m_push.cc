@@ -10,11 +10,26 @@
 
 namespace ircd::m::push
 {
+	struct prog;
+	struct crule;
+	struct ruleset;
+	struct subject;
+	struct batch;
+
+	static crule compile(const event::idx &, const path &, const json::object &);
+	static std::shared_ptr<const ruleset> compile(const user::id &);
+	static subject &get(const user::id &);
+	static void invalidate(const event &);
+
+	static bool test(batch &, subject &, const user::id &, const prog &);
+	static bool matching(batch &, subject &, const user::id &, const crule &);
 	static void execute(const event &, vm::eval &, const user::id &, const path &, const rule &, const event::idx &);
-	static bool matching(const event &, vm::eval &, const user::id &, const path &, const rule &);
-	static bool handle_kind(const event &, vm::eval &, const user::id &, const path &);
-	static void handle_rules(const event &, vm::eval &, const user::id &, const string_view &scope);
+	static void handle_rules(batch &, vm::eval &, const user::id &);
 	static void handle_event(const m::event &, vm::eval &);
+
+	extern conf::item<bool> compile_enable;
+	extern std::map<std::string, subject, std::less<>> subjects;
+	extern std::shared_ptr<const ruleset> default_ruleset;
 	extern hookfn<vm::eval &> hook_event;
 }
 
@@ -24,6 +39,90 @@ IRCD_MODULE
 	"Matrix 13.13 :Push Notifications",
 };
 
+/// A condition of a rule reduced to an opcode and its operands. Conditions
+/// whose result doesn't depend on the user (i.e. room_member_count) are kept
+/// as JSON and evaluated once per event for all users. Any other kind is kept
+/// as JSON and evaluated for each user.
+struct ircd::m::push::prog
+{
+	enum op :uint8_t;
+
+	enum op op;
+	std::string key;
+	std::string pattern;
+	std::string cond;
+};
+
+enum ircd::m::push::prog::op
+:uint8_t
+{
+	EVENT_MATCH,
+	EVENT_MATCH_EXACT,
+	CONTAINS_USER_MXID,
+	STATE_KEY_USER_MXID,
+	CONTAINS_DISPLAY_NAME,
+	INVARIANT,
+	CONDITION,
+};
+
+struct ircd::m::push::crule
+{
+	std::string scope, kind, rule_id;
+	event::idx rule_idx {0};
+	std::string rule;
+	std::vector<prog> conds;
+};
+
+/// The rules of a user in the order they're evaluated. Users who haven't
+/// set any rules of their own share the default_ruleset.
+struct ircd::m::push::ruleset
+{
+	std::vector<crule> rules;
+};
+
+struct ircd::m::push::subject
+{
+	std::shared_ptr<const ruleset> rules;
+	std::string displayname;
+	bool displayname_valid {false};
+};
+
+/// State shared by the evaluation of all users for one event. The keys are
+/// copied because the ruleset they came from may be freed by invalidate()
+/// while the batch yields.
+struct ircd::m::push::batch
+{
+	const m::event &event;
+	json::string body;
+	json::string formatted_body;
+	std::vector<std::pair<std::string, string_view>> values;
+	std::map<std::string, bool, std::less<>> invariant;
+
+	string_view value(const string_view &key);
+
+	batch(const m::event &);
+};
+
+decltype(ircd::m::push::compile_enable)
+ircd::m::push::compile_enable
+{
+	{ "name",     "ircd.m.push.compile.enable" },
+	{ "default",  true                         },
+	{ "description",
+
+	R"(
+	Keep the push rules of each user compiled in memory rather than reading
+	them from the user's room for every event. When disabled the rules are
+	compiled again for each event.
+	)"},
+};
+
+decltype(ircd::m::push::subjects)
+ircd::m::push::subjects;
+
+decltype(ircd::m::push::default_ruleset)
+ircd::m::push::default_ruleset;
+
 decltype(ircd::m::push::hook_event)
 ircd::m::push::hook_event
 {
@@ -38,6 +137,8 @@ ircd::m::push::handle_event(const m::event &event,
                             vm::eval &eval)
 try
 {
+	invalidate(event);
+
 	// No push notifications are generated from events in internal rooms.
 	if(eval.room_internal)
 		return;
@@ -56,15 +157,20 @@ try
 		room_id
 	};
 
-	members.for_each("join", my_host(), [&event, &eval]
+	batch batch
+	{
+		event
+	};
+
+	members.for_each("join", my_host(), [&batch, &eval]
 	(const user::id &user_id, const event::idx &membership_event_idx)
 	{
 		// r0.6.0-13.13.15 Homeservers MUST NOT notify the Push Gateway for
 		// events that the user has sent themselves.
-		if(user_id == at<"sender"_>(event))
+		if(user_id == at<"sender"_>(batch.event))
 			return true;
 
-		handle_rules(event, eval, user_id, "global");
+		handle_rules(batch, eval, user_id);
 		return true;
 	});
 }
@@ -83,109 +189,396 @@ catch(const std::exception &e)
 }
 
 void
-ircd::m::push::handle_rules(const event &event,
+ircd::m::push::handle_rules(batch &batch,
                             vm::eval &eval,
-                            const user::id &user_id,
-                            const string_view &scope)
+                            const user::id &user_id)
 {
-	const push::path path[]
+	const auto &event
+	{
+		batch.event
+	};
+
+	// The subject may be invalidated while yielding in execute().
+	subject subject
 	{
-		{ scope, "override",   string_view{}         },
-		{ scope, "content",    string_view{}         },
-		{ scope, "room",       at<"room_id"_>(event) },
-		{ scope, "sender",     at<"sender"_>(event)  },
-		{ scope, "underride",  string_view{}         },
+		compile_enable?
+			get(user_id):
+			push::subject{compile(user_id)}
 	};
 
-	for(const auto &p : path)
-		if(!handle_kind(event, eval, user_id, p))
-			break;
+	assert(subject.rules);
+	for(const auto &rule : subject.rules->rules)
+	{
+		if(rule.kind == "room" && rule.rule_id != at<"room_id"_>(event))
+			continue;
+
+		if(rule.kind == "sender" && rule.rule_id != at<"sender"_>(event))
+			continue;
+
+		if(!matching(batch, subject, user_id, rule))
+			continue;
+
+		const push::path path
+		{
+			rule.scope, rule.kind, rule.rule_id
+		};
+
+		execute(event, eval, user_id, path, json::object{rule.rule}, rule.rule_idx);
+		break;
+	}
 }
 
 bool
-ircd::m::push::handle_kind(const event &event,
-                           vm::eval &eval,
-                           const user::id &user_id,
-                           const path &path)
+ircd::m::push::matching(batch &batch,
+                        subject &subject,
+                        const user::id &user_id,
+                        const crule &rule)
+try
 {
-	const user::pushrules pushrules
+	for(const auto &cond : rule.conds)
+		if(!test(batch, subject, user_id, cond))
+			return false;
+
+	return true;
+}
+catch(const ctx::interrupted &)
+{
+	throw;
+}
+catch(const std::exception &e)
+{
+	log::error
 	{
-		user_id
+		log, "Push rule matching in %s for %s at { %s, %s, %s } :%s",
+		string_view{batch.event.event_id},
+		string_view{user_id},
+		rule.scope,
+		rule.kind,
+		rule.rule_id,
+		e.what(),
 	};
 
-	return pushrules.for_each(path, [&event, &eval, &user_id]
-	(const auto &event_idx, const auto &path, const auto &rule)
+	return false;
+}
+
+bool
+ircd::m::push::test(batch &batch,
+                    subject &subject,
+                    const user::id &user_id,
+                    const prog &cond)
+{
+	switch(cond.op)
 	{
-		if(matching(event, eval, user_id, path, rule))
+		case prog::EVENT_MATCH:
+			return globular_imatch{cond.pattern}(batch.value(cond.key));
+
+		case prog::EVENT_MATCH_EXACT:
+			return iequals(cond.pattern, batch.value(cond.key));
+
+		case prog::CONTAINS_USER_MXID:
+			return has(batch.body, user_id) || has(batch.formatted_body, user_id);
+
+		case prog::STATE_KEY_USER_MXID:
+			return json::get<"state_key"_>(batch.event) == user_id;
+
+		case prog::CONTAINS_DISPLAY_NAME:
 		{
-			execute(event, eval, user_id, path, rule, event_idx);
-			return false; // false to break due to match
+			if(!batch.body)
+				return false;
+
+			if(!subject.displayname_valid)
+			{
+				const m::user::profile profile
+				{
+					user_id
+				};
+
+				profile.get(std::nothrow, "displayname", [&subject]
+				(const string_view &, const json::string &displayname)
+				{
+					subject.displayname = displayname;
+				});
+
+				subject.displayname_valid = true;
+				const auto it(subjects.find(user_id));
+				if(it != end(subjects))
+				{
+					it->second.displayname = subject.displayname;
+					it->second.displayname_valid = true;
+				}
+			}
+
+			return !subject.displayname.empty() && has(batch.body, subject.displayname);
 		}
-		else return true;
-	});
+
+		case prog::INVARIANT:
+		{
+			auto it(batch.invariant.lower_bound(cond.cond));
+			if(it != end(batch.invariant) && it->first == cond.cond)
+				return it->second;
+
+			push::match::opts opts;
+			opts.user_id = user_id;
+			const push::match match
+			{
+				batch.event, push::cond{json::object{cond.cond}}, opts
+			};
+
+			batch.invariant.emplace_hint(it, cond.cond, bool(match));
+			return bool(match);
+		}
+
+		case prog::CONDITION:
+		{
+			push::match::opts opts;
+			opts.user_id = user_id;
+			const push::match match
+			{
+				batch.event, push::cond{json::object{cond.cond}}, opts
+			};
+
+			return bool(match);
+		}
+	}
+
+	return false;
 }
 
-bool
-ircd::m::push::matching(const event &event,
-                        vm::eval &eval,
-                        const user::id &user_id,
-                        const path &path,
-                        const rule &rule)
-try
+//
+// batch
+//
+
+ircd::m::push::batch::batch(const m::event &event)
+:event
 {
-	const auto &[scope, kind, ruleid]
+	event
+}
+,body
+{
+	json::get<"content"_>(event).get("body")
+}
+,formatted_body
+{
+	json::get<"content"_>(event).get("formatted_body")
+}
+{
+}
+
+/// Resolve the dot-separated key of an event_match condition.
+ircd::string_view
+ircd::m::push::batch::value(const string_view &key)
+{
+	const auto it
 	{
-		path
+		std::find_if(begin(values), end(values), [&key](const auto &kv)
+		{
+			return kv.first == key;
+		})
 	};
 
-	if(!json::get<"enabled"_>(rule))
+	if(it != end(values))
+		return it->second;
+
+	const auto &[top, path]
+	{
+		split(key, '.')
+	};
+
+	string_view value
+	{
+		json::get(event, top, json::object{})
+	};
+
+	tokens(path, ".", token_view_bool{[&value]
+	(const string_view &key)
+	{
+		if(!json::type(value, json::OBJECT))
+			return false;
+
+		value = json::object(value)[key];
+		if(likely(!json::type(value, json::STRING)))
+			return true;
+
+		value = json::string(value);
 		return false;
+	}});
+
+	values.emplace_back(key, value);
+	return value;
+}
+
+//
+// subject
+//
+
+ircd::m::push::subject &
+ircd::m::push::get(const user::id &user_id)
+{
+	auto it(subjects.lower_bound(user_id));
+	if(it != end(subjects) && it->first == user_id && it->second.rules)
+		return it->second;
 
-	push::match::opts opts;
-	opts.user_id = user_id;
-	const push::match match
+	auto rules
 	{
-		event, rule, opts
+		compile(user_id)
 	};
 
-	#if 0
-	log::debug
+	// Compiling yields; the iterator is found again.
+	it = subjects.lower_bound(user_id);
+	if(it == end(subjects) || it->first != user_id)
+		it = subjects.emplace_hint(it, std::string{user_id}, subject{});
+
+	if(!it->second.rules)
+		it->second.rules = std::move(rules);
+
+	return it->second;
+}
+
+/// Compiled rules are dropped when the user changes a rule; the cached
+/// displayname is dropped when the user's profile changes.
+void
+ircd::m::push::invalidate(const event &event)
+{
+	const auto &type
 	{
-		log, "event %s rule { %s, %s, %s } for %s %s",
-		string_view{event.event_id},
-		scope,
-		kind,
-		ruleid,
-		string_view{user_id},
-		bool(match)? "MATCH"_sv : string_view{}
+		json::get<"type"_>(event)
 	};
-	#endif
 
-	return bool(match);
+	const bool rule_type
+	{
+		startswith(type, rule::type_prefix)
+	};
+
+	if(!rule_type && type != "ircd.profile")
+		return;
+
+	const auto &sender
+	{
+		json::get<"sender"_>(event)
+	};
+
+	if(!m::user::room::is(json::get<"room_id"_>(event), sender))
+		return;
+
+	const auto it
+	{
+		subjects.find(sender)
+	};
+
+	if(it == end(subjects))
+		return;
+
+	if(rule_type)
+		subjects.erase(it);
+	else
+		it->second.displayname_valid = false;
 }
-catch(const ctx::interrupted &)
+
+//
+// compile
+//
+
+std::shared_ptr<const ircd::m::push::ruleset>
+ircd::m::push::compile(const user::id &user_id)
 {
-	throw;
+	static const string_view kinds[]
+	{
+		"override", "content", "room", "sender", "underride"
+	};
+
+	const user::pushrules pushrules
+	{
+		user_id
+	};
+
+	auto ret
+	{
+		std::make_shared<ruleset>()
+	};
+
+	bool defaults {true};
+	for(const auto &kind : kinds)
+		pushrules.for_each(path{"global", kind, string_view{}}, [&ret, &defaults]
+		(const auto &event_idx, const auto &path, const json::object &rule)
+		{
+			defaults &= event_idx == 0;
+			if(!json::get<"enabled"_>(push::rule{rule}))
+				return true;
+
+			ret->rules.emplace_back(compile(event_idx, path, rule));
+			return true;
+		});
+
+	if(!defaults)
+		return ret;
+
+	if(!default_ruleset)
+		default_ruleset = std::move(ret);
+
+	return default_ruleset;
 }
-catch(const std::exception &e)
+
+ircd::m::push::crule
+ircd::m::push::compile(const event::idx &event_idx,
+                       const path &path,
+                       const json::object &object)
 {
-	const auto &[scope, kind, ruleid]
+	const auto &[scope, kind, rule_id]
 	{
 		path
 	};
 
-	log::error
+	const push::rule rule
 	{
-		log, "Push rule matching in %s for %s at { %s, %s, %s } :%s",
-		string_view{event.event_id},
-		string_view{user_id},
-		scope,
-		kind,
-		ruleid,
-		e.what(),
+		object
 	};
 
-	return false;
+	crule ret;
+	ret.scope = scope;
+	ret.kind = kind;
+	ret.rule_id = rule_id;
+	ret.rule_idx = event_idx;
+	ret.rule = object;
+
+	const auto event_match{[&ret]
+	(const string_view &key, const string_view &pattern)
+	{
+		const bool glob
+		{
+			pattern.find_first_of("*?") != pattern.npos
+		};
+
+		ret.conds.emplace_back(prog
+		{
+			glob? prog::EVENT_MATCH: prog::EVENT_MATCH_EXACT, std::string{key}, std::string{pattern}
+		});
+	}};
+
+	if(json::get<"pattern"_>(rule))
+		event_match("content.body", json::get<"pattern"_>(rule));
+
+	for(const json::object cond : json::get<"conditions"_>(rule))
+	{
+		const json::string kind
+		{
+			cond["kind"]
+		};
+
+		if(kind == "event_match")
+			event_match(json::string(cond["key"]), json::string(cond["pattern"]));
+		else if(kind == "contains_user_mxid")
+			ret.conds.emplace_back(prog{prog::CONTAINS_USER_MXID});
+		else if(kind == "state_key_user_mxid")
+			ret.conds.emplace_back(prog{prog::STATE_KEY_USER_MXID});
+		else if(kind == "contains_display_name")
+			ret.conds.emplace_back(prog{prog::CONTAINS_DISPLAY_NAME});
+		else if(kind == "room_member_count" || kind == "sender_notification_permission")
+			ret.conds.emplace_back(prog{prog::INVARIANT, {}, {}, std::string{cond}});
+		else
+			ret.conds.emplace_back(prog{prog::CONDITION, {}, {}, std::string{cond}});
+	}
+
+	return ret;
 }
 
 void
@@ -42,4 +42,9 @@ namespace ircd::m::media::thumbnail
 	extern conf::item<size_t> height_max;
 	extern conf::item<std::string> mime_whitelist;
 	extern conf::item<std::string> mime_blacklist;
+	extern conf::item<bool> cache_enable;
+	extern conf::item<size_t> concurrency;
+	extern std::set<std::string, std::less<>> working;
+	extern size_t generating;
+	extern ctx::dock dock;
 }
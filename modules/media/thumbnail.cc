@@ -69,6 +69,43 @@ ircd::m::media::thumbnail::mime_blacklist
 	{ "default",  ""                                      },
 };
 
+decltype(ircd::m::media::thumbnail::cache_enable)
+ircd::m::media::thumbnail::cache_enable
+{
+	{ "name",     "ircd.m.media.thumbnail.cache.enable" },
+	{ "default",  true                                  },
+	{ "description",
+
+	R"(
+	Store generated thumbnails in the media blocks column, keyed by the mxc,
+	dimensions and method, and serve later requests from there.
+	)"},
+};
+
+decltype(ircd::m::media::thumbnail::concurrency)
+ircd::m::media::thumbnail::concurrency
+{
+	{ "name",     "ircd.m.media.thumbnail.concurrency" },
+	{ "default",  2L                                   },
+	{ "description",
+
+	R"(
+	Maximum number of thumbnails generated at the same time. Generation is
+	offloaded from the main thread; requests beyond this limit wait.
+	)"},
+};
+
+/// Keys of thumbnails being generated; requests for the same key wait for
+/// the first one to finish and are then served from the cache.
+decltype(ircd::m::media::thumbnail::working)
+ircd::m::media::thumbnail::working;
+
+decltype(ircd::m::media::thumbnail::generating)
+ircd::m::media::thumbnail::generating;
+
+decltype(ircd::m::media::thumbnail::dock)
+ircd::m::media::thumbnail::dock;
+
 m::resource
 thumbnail_resource__legacy
 {
@@ -95,6 +132,27 @@ get__thumbnail_local(client &client,
                      const m::media::mxc &,
                      const m::room &room);
 
+static std::string
+generate(const const_buffer &,
+         const string_view &method,
+         const pair<size_t> &dimension);
+
+static bool
+get__thumbnail_cached(client &client,
+                      const string_view &key,
+                      const string_view &content_type);
+
+static string_view
+make_key(const mutable_buffer &,
+         const m::media::mxc &,
+         const string_view &method,
+         const pair<size_t> &dimension);
+
+static size_t
+snap(const size_t &val,
+     const size_t &min,
+     const size_t &max);
+
 m::resource::response
 get__thumbnail(client &client,
                const m::resource::request &request)
@@ -177,25 +235,38 @@ get__thumbnail_local(client &client,
                      const m::media::mxc &mxc,
                      const m::room &room)
 {
-	const auto &method
+	const string_view &_method
 	{
 		request.query.get("method", "scale"_sv)
 	};
 
+	// Only two methods exist; anything else is rejected below, so the
+	// canonical literal is used for the cache key rather than the input.
+	const string_view method
+	{
+		_method == "crop"?
+			"crop"_sv:
+		_method == "scale"?
+			"scale"_sv:
+			_method
+	};
+
 	const size_t _dimension[]
 	{
 		request.query.get<size_t>("width", 0),
 		request.query.get<size_t>("height", 0),
 	};
 
+	// Dimensions are snapped to a fixed set so the number of cached
+	// thumbnails for any one file is bounded regardless of the queries.
 	const pair<size_t> dimension
 	{
 		_dimension[0]?
-			std::clamp(_dimension[0], size_t(width_min), size_t(width_max)):
+			snap(_dimension[0], width_min, width_max):
 			_dimension[0],
 
 		_dimension[1]?
-			std::clamp(_dimension[1], size_t(height_min), size_t(height_max)):
+			snap(_dimension[1], height_min, height_max):
 			_dimension[1]
 	};
 
@@ -238,35 +309,6 @@ get__thumbnail_local(client &client,
 		};
 	});
 
-	const unique_buffer<mutable_buffer> buf
-	{
-		file_size
-	};
-
-	size_t copied(0);
-	const auto sink{[&buf, &copied]
-	(const const_buffer &block)
-	{
-		copied += copy(buf + copied, block);
-	}};
-
-	const size_t read_size
-	{
-		m::media::file::read(room, sink)
-	};
-
-	if(unlikely(read_size != file_size || file_size != copied))
-		throw ircd::error
-		{
-			"File %s/%s [%s] size mismatch: expected %zu got %zu copied %zu",
-			mxc.server,
-			mxc.mediaid,
-			string_view{room.room_id},
-			file_size,
-			read_size,
-			copied
-		};
-
 	const auto mime_type
 	{
 		split(content_type, ';').first
@@ -321,6 +363,73 @@ get__thumbnail_local(client &client,
 				"Unknown reason",
 		};
 
+	char key_buf[512];
+	const string_view key
+	{
+		!fallback?
+			make_key(key_buf, mxc, method, dimension):
+			string_view{}
+	};
+
+	// Serve from the cache or wait for another request already generating
+	// the same thumbnail to finish.
+	while(!fallback)
+	{
+		if(cache_enable && get__thumbnail_cached(client, key, content_type))
+			return {};
+
+		if(!working.count(key))
+			break;
+
+		dock.wait([&key]
+		{
+			return !working.count(key);
+		});
+	}
+
+	const bool leader
+	{
+		!fallback && working.emplace(key).second
+	};
+
+	const unwind release{[&leader, &key]
+	{
+		if(!leader)
+			return;
+
+		working.erase(working.find(key));
+		dock.notify_all();
+	}};
+
+	const unique_buffer<mutable_buffer> buf
+	{
+		file_size
+	};
+
+	size_t copied(0);
+	const auto sink{[&buf, &copied]
+	(const const_buffer &block)
+	{
+		copied += copy(buf + copied, block);
+	}};
+
+	const size_t read_size
+	{
+		m::media::file::read(room, sink)
+	};
+
+	if(unlikely(read_size != file_size || file_size != copied))
+		throw ircd::error
+		{
+			"File %s/%s [%s] size mismatch: expected %zu got %zu copied %zu",
+			mxc.server,
+			mxc.mediaid,
+			string_view{room.room_id},
+			file_size,
+			read_size,
+			copied
+		};
+
 	static const auto &addl_headers
 	{
 		"Cache-Control: public, max-age=31536000, immutable\r\n"_sv
@@ -332,25 +441,130 @@ get__thumbnail_local(client &client,
 			client, buf, content_type, http::OK, addl_headers
 		};
 
-	const auto closure{[&client, &content_type]
+	const std::string thumb
+	{
+		generate(buf, method, dimension)
+	};
+
+	if(cache_enable && !empty(thumb))
+		db::write(m::media::blocks, key, const_buffer{thumb});
+
+	return m::resource::response
+	{
+		client, const_buffer{thumb}, content_type, http::OK, addl_headers
+	};
+}
+
+/// Runs the library off the main thread with at most `concurrency` jobs at
+/// once; the caller's context waits.
+std::string
+generate(const const_buffer &buf,
+         const string_view &method,
+         const pair<size_t> &dimension)
+{
+	dock.wait([]
+	{
+		return generating < size_t(concurrency);
+	});
+
+	++generating;
+	const unwind done{[]
+	{
+		--generating;
+		dock.notify_all();
+	}};
+
+	std::string ret;
+	const auto closure{[&ret]
 	(const const_buffer &buf)
 	{
-		m::resource::response
-		{
-			client, buf, content_type, http::OK, addl_headers
-		};
+		ret.assign(data(buf), size(buf));
 	}};
 
-	if(method == "crop")
-		magick::thumbcrop
-		{
-			buf, dimension, closure
-		};
-	else
-		magick::thumbnail
+	const bool crop
+	{
+		method == "crop"
+	};
+
+	const ctx::ole::opts opts
+	{
+		"media.thumbnail"
+	};
+
+	ctx::offload(opts, [&]
+	{
+		if(crop)
+			magick::thumbcrop
+			{
+				buf, dimension, closure
+			};
+		else
+			magick::thumbnail
+			{
+				buf, dimension, closure
+			};
+	});
+
+	return ret;
+}
+
+bool
+get__thumbnail_cached(client &client,
+                      const string_view &key,
+                      const string_view &content_type)
+{
+	static const auto &addl_headers
+	{
+		"Cache-Control: public, max-age=31536000, immutable\r\n"_sv
+	};
+
+	return m::media::blocks(key, std::nothrow, [&client, &content_type]
+	(const string_view &thumb)
+	{
+		m::resource::response
 		{
-			buf, dimension, closure
+			client, thumb, content_type, http::OK, addl_headers
 		};
+	});
+}
+
+/// Thumbnails share the blocks column with the file blocks; their keys have
+/// characters which are not in the base58 alphabet of the block hashes.
+string_view
+make_key(const mutable_buffer &buf,
+         const m::media::mxc &mxc,
+         const string_view &method,
+         const pair<size_t> &dimension)
+{
+	return fmt::sprintf
+	{
+		buf, "thumbnail/%s/%s/%zu$x%zu/%s",
+		mxc.server,
+		mxc.mediaid,
+		dimension.first,
+		dimension.second,
+		method,
+	};
+}
+
+/// Rounds up to the next power of two within the configured bounds; the
+/// client receives a thumbnail at least as large as it asked for.
+size_t
+snap(const size_t &val,
+     const size_t &min,
+     const size_t &max)
+{
+	const size_t clamped
+	{
+		std::clamp(val, min, max)
+	};
+
+	const size_t pow2
+	{
+		clamped > 1?
+			1UL << (64 - __builtin_clzl(clamped - 1)):
+			clamped
+	};
 
-	return {}; // responded from closure.
+	return std::min(pow2, max);
 }
@@ -10,17 +10,47 @@
 
 namespace ircd::net::dns::cache
 {
-	static void handle(const m::event &, m::vm::eval &);
+	struct entry;
+
+	static string_view make_key(const mutable_buffer &, const string_view &type, const string_view &state_key);
+	static std::string mem_get(const string_view &key, time_t &ts);
+	static void mem_put(const string_view &key, const json::object &content, const time_t &ts);
+	static void mem_erase(const string_view &key);
+	static bool room_get(const string_view &type, const string_view &state_key, const m::event::closure_idx &);
+	static bool commit(const string_view &type, const string_view &state_key, const json::object &content);
 
 	static bool put(const string_view &type, const string_view &state_key, const records &rrs);
 	static bool put(const string_view &type, const string_view &state_key, const uint &code, const string_view &msg);
 
+	static void write(const string_view &key, const string_view &content);
+	static void writer();
+
+	extern conf::item<size_t> mem_max;
+	extern ircd::stats::item<uint64_t> stats_hits;
+	extern ircd::stats::item<uint64_t> stats_misses;
+	extern ircd::stats::item<uint64_t> stats_expired;
+	extern ircd::stats::item<uint64_t> stats_evicted;
+	extern ircd::stats::item<uint64_t> stats_writes;
+	extern std::list<entry> mem_lru;
+	extern std::map<string_view, std::list<entry>::iterator> mem_map;
+	extern std::map<std::string, std::string, std::less<>> writes;
+	extern ctx::dock writer_dock;
+	extern context writer_context;
+
 	extern const m::room::id::buf dns_room_id;
-	extern m::hookfn<m::vm::eval &> hook;
 
 	static void init(), fini();
 }
 
+/// Entry in the memory tier. The key is type and state_key separated by a
+/// null; content is the same object found in the room.
+struct ircd::net::dns::cache::entry
+{
+	std::string key;
+	std::string content;
+	time_t ts;
+};
+
 ircd::mapi::header
 IRCD_MODULE
 {
@@ -35,14 +65,73 @@ ircd::net::dns::cache::dns_room_id
 	"dns", m::my_host()
 };
 
-decltype(ircd::net::dns::cache::hook)
-ircd::net::dns::cache::hook
+decltype(ircd::net::dns::cache::mem_max)
+ircd::net::dns::cache::mem_max
 {
-	ircd::net::dns::cache::handle,
-	{
-		{ "_site",    "vm.effect"              },
-		{ "room_id",  string_view{dns_room_id} },
-	}
+	{ "name",     "ircd.net.dns.cache.mem.max" },
+	{ "default",  16384L                       },
+	{ "description",
+
+	R"(
+	Maximum number of answers kept in memory in front of the cache room. The
+	least recently used are evicted; the room still has them.
+	)"},
+};
+
+decltype(ircd::net::dns::cache::stats_hits)
+ircd::net::dns::cache::stats_hits
+{
+	{ "name", "ircd.net.dns.cache.hits"                           },
+	{ "desc", "Number of cache queries answered from memory."     },
+};
+
+decltype(ircd::net::dns::cache::stats_misses)
+ircd::net::dns::cache::stats_misses
+{
+	{ "name", "ircd.net.dns.cache.misses"                         },
+	{ "desc", "Number of cache queries not found in memory."      },
+};
+
+decltype(ircd::net::dns::cache::stats_expired)
+ircd::net::dns::cache::stats_expired
+{
+	{ "name", "ircd.net.dns.cache.expired"                        },
+	{ "desc", "Number of answers found in memory with all records expired." },
+};
+
+decltype(ircd::net::dns::cache::stats_evicted)
+ircd::net::dns::cache::stats_evicted
+{
+	{ "name", "ircd.net.dns.cache.evicted"                        },
+	{ "desc", "Number of answers evicted from memory for space."  },
+};
+
+decltype(ircd::net::dns::cache::stats_writes)
+ircd::net::dns::cache::stats_writes
+{
+	{ "name", "ircd.net.dns.cache.writes"                         },
+	{ "desc", "Number of answers written to the cache room."      },
+};
+
+decltype(ircd::net::dns::cache::mem_lru)
+ircd::net::dns::cache::mem_lru;
+
+decltype(ircd::net::dns::cache::mem_map)
+ircd::net::dns::cache::mem_map;
+
+decltype(ircd::net::dns::cache::writes)
+ircd::net::dns::cache::writes;
+
+decltype(ircd::net::dns::cache::writer_dock)
+ircd::net::dns::cache::writer_dock;
+
+decltype(ircd::net::dns::cache::writer_context)
+ircd::net::dns::cache::writer_context
+{
+	"dns.cache",
+	256_KiB,
+	context::WAIT_JOIN,
+	writer,
 };
 
 void
@@ -69,6 +158,14 @@ ircd::net::dns::cache::fini()
 	{
 		return waiting.empty();
 	});
+
+	// The writer drains the queue before it exits.
+	writer_context.terminate();
+	writer_dock.notify_all();
+	writer_context.join();
+
+	mem_map.clear();
+	mem_lru.clear();
 }
 
 bool
@@ -166,16 +263,7 @@ try
 	rr0.~object();
 	array.~array();
 	content.~object();
-	const m::room room
-	{
-		dns_room_id
-	};
-
-	if(unlikely(!exists(room)))
-		create(room, m::me(), "internal");
-
-	send(room, m::me(), type, state_key, json::object(out.completed()));
-	return true;
+	return commit(type, state_key, json::object(out.completed()));
 }
 catch(const http::error &e)
 {
@@ -294,16 +382,7 @@ try
 
 	array.~array();
 	content.~object();
-	const m::room room
-	{
-		dns_room_id
-	};
-
-	if(unlikely(!exists(room)))
-		create(room, m::me(), "internal");
-
-	send(room, m::me(), type, state_key, json::object{out.completed()});
-	return true;
+	return commit(type, state_key, json::object{out.completed()});
 }
 catch(const http::error &e)
 {
@@ -372,44 +451,64 @@ ircd::net::dns::cache::get(const hostport &hp,
 			host(hp)
 	};
 
-	const m::room::state state
+	char key_buf[128 + rfc1035::NAME_BUFSIZE * 2];
+	const string_view key
 	{
-		dns_room_id
+		make_key(key_buf, type, state_key)
 	};
 
-	const m::event::idx &event_idx
+	time_t ts;
+	std::string content
 	{
-		state.get(std::nothrow, type, state_key)
+		mem_get(key, ts)
 	};
 
-	if(!event_idx)
-		return false;
+	if(content.empty())
+		room_get(type, state_key, [&key, &content, &ts]
+		(const m::event::idx &event_idx)
+		{
+			time_t origin_server_ts;
+			if(!m::get<time_t>(event_idx, "origin_server_ts", origin_server_ts))
+				return;
+
+			ts = origin_server_ts / 1000L;
+			m::get(std::nothrow, event_idx, "content", [&content]
+			(const json::object &object)
+			{
+				content = object;
+			});
+
+			if(!content.empty())
+				mem_put(key, content, ts);
+		});
 
-	time_t origin_server_ts;
-	if(!m::get<time_t>(event_idx, "origin_server_ts", origin_server_ts))
+	if(content.empty())
 		return false;
 
-	bool ret{false};
-	const time_t ts{origin_server_ts / 1000L};
-	m::get(std::nothrow, event_idx, "content", [&hp, &closure, &ret, &ts]
-	(const json::object &content)
+	const json::array &rrs
 	{
-		const json::array &rrs
-		{
-			content.get("")
-		};
+		json::object(content).get("")
+	};
 
-		// If all records are expired then skip; otherwise since this closure
-		// expects a single array we reveal both expired and valid records.
-		ret = !std::all_of(begin(rrs), end(rrs), [&ts]
+	// If all records are expired then skip; otherwise since this closure
+	// expects a single array we reveal both expired and valid records.
+	const bool ret
+	{
+		!std::all_of(begin(rrs), end(rrs), [&ts]
 		(const json::object &rr)
 		{
 			return expired(rr, ts);
-		});
+		})
+	};
 
-		if(ret && closure)
-			closure(hp, rrs);
-	});
+	if(!ret)
+	{
+		++stats_expired;
+		mem_erase(key);
+	}
+
+	if(ret && closure)
+		closure(hp, rrs);
 
 	return ret;
 }
@@ -434,39 +533,56 @@ ircd::net::dns::cache::for_each(const hostport &hp,
 			host(hp)
 	};
 
-	const m::room::state state
+	char key_buf[128 + rfc1035::NAME_BUFSIZE * 2];
+	const string_view key
 	{
-		dns_room_id
+		make_key(key_buf, type, state_key)
 	};
 
-	const m::event::idx &event_idx
+	time_t ts;
+	const std::string content
 	{
-		state.get(std::nothrow, type, state_key)
+		mem_get(key, ts)
 	};
 
-	if(!event_idx)
-		return false;
-
-	time_t origin_server_ts;
-	if(!m::get<time_t>(event_idx, "origin_server_ts", origin_server_ts))
-		return false;
-
-	bool ret{true};
-	const time_t ts{origin_server_ts / 1000L};
-	m::get(std::nothrow, event_idx, "content", [&state_key, &closure, &ret, &ts]
-	(const json::object &content)
+	const auto each{[&state_key, &closure]
+	(const json::object &content, const time_t &ts)
 	{
 		for(const json::object rr : json::array(content.get("")))
 		{
 			if(expired(rr, ts))
 				continue;
 
-			if(!(ret = closure(state_key, rr)))
-				break;
+			if(!closure(state_key, rr))
+				return false;
 		}
-	});
 
-	return ret;
+		return true;
+	}};
+
+	if(!content.empty())
+		return each(content, ts);
+
+	bool ret{true};
+	const bool found
+	{
+		room_get(type, state_key, [&each, &ret]
+		(const m::event::idx &event_idx)
+		{
+			time_t origin_server_ts;
+			if(!m::get<time_t>(event_idx, "origin_server_ts", origin_server_ts))
+				return;
+
+			const time_t ts{origin_server_ts / 1000L};
+			m::get(std::nothrow, event_idx, "content", [&each, &ret, &ts]
+			(const json::object &content)
+			{
+				ret = each(content, ts);
+			});
+		})
+	};
+
+	return found && ret;
 }
 
 bool
@@ -511,36 +627,202 @@ ircd::net::dns::cache::for_each(const string_view &type,
 	});
 }
 
+/// Answers are put in memory and waiters are called right away; the write
+/// to the room is queued for the writer context. This is the only place the
+/// waiters are called for an answer; the room write doesn't call them again.
+bool
+ircd::net::dns::cache::commit(const string_view &type,
+                              const string_view &state_key,
+                              const json::object &content)
+{
+	char key_buf[128 + rfc1035::NAME_BUFSIZE * 2];
+	const string_view key
+	{
+		make_key(key_buf, type, state_key)
+	};
+
+	mem_put(key, content, ircd::time());
+
+	auto it(writes.lower_bound(key));
+	if(it == end(writes) || it->first != key)
+		it = writes.emplace_hint(it, std::string{key}, std::string{});
+
+	it->second = content;
+	writer_dock.notify_one();
+
+	waiter::call(rfc1035::qtype.at(lstrip(type, "ircd.dns.rrs.")), state_key, content.get(""));
+	return true;
+}
+
+bool
+ircd::net::dns::cache::room_get(const string_view &type,
+                                const string_view &state_key,
+                                const m::event::closure_idx &closure)
+{
+	const m::room::state state
+	{
+		dns_room_id
+	};
+
+	const m::event::idx &event_idx
+	{
+		state.get(std::nothrow, type, state_key)
+	};
+
+	if(!event_idx)
+		return false;
+
+	closure(event_idx);
+	return true;
+}
+
+//
+// memory tier
+//
+
+std::string
+ircd::net::dns::cache::mem_get(const string_view &key,
+                               time_t &ts)
+{
+	const auto it
+	{
+		mem_map.find(key)
+	};
+
+	if(it == end(mem_map))
+	{
+		++stats_misses;
+		return {};
+	}
+
+	++stats_hits;
+	mem_lru.splice(begin(mem_lru), mem_lru, it->second);
+	ts = it->second->ts;
+	return it->second->content;
+}
+
+void
+ircd::net::dns::cache::mem_put(const string_view &key,
+                               const json::object &content,
+                               const time_t &ts)
+{
+	mem_erase(key);
+	while(!mem_lru.empty() && mem_lru.size() >= size_t(mem_max))
+	{
+		mem_map.erase(mem_lru.back().key);
+		mem_lru.pop_back();
+		++stats_evicted;
+	}
+
+	if(!size_t(mem_max))
+		return;
+
+	mem_lru.emplace_front(entry
+	{
+		std::string{key}, std::string{content}, ts
+	});
+
+	mem_map.emplace(mem_lru.front().key, begin(mem_lru));
+}
+
 void
-ircd::net::dns::cache::handle(const m::event &event,
-                              m::vm::eval &eval)
-try
+ircd::net::dns::cache::mem_erase(const string_view &key)
 {
-	const string_view &type
+	const auto it
 	{
-		json::get<"type"_>(event)
+		mem_map.find(key)
 	};
 
-	if(!startswith(type, "ircd.dns.rrs."))
+	if(it == end(mem_map))
 		return;
 
-	const string_view &state_key
+	const auto lit(it->second);
+	mem_map.erase(it);
+	mem_lru.erase(lit);
+}
+
+ircd::string_view
+ircd::net::dns::cache::make_key(const mutable_buffer &buf,
+                                const string_view &type,
+                                const string_view &state_key)
+{
+	mutable_buffer out{buf};
+	consume(out, copy(out, type));
+	consume(out, copy(out, '\0'));
+	consume(out, copy(out, state_key));
+	return { data(buf), data(out) };
+}
+
+//
+// writer
+//
+
+/// Persists answers to the room so the cache survives a restart. Everything
+/// queued is taken at once; an answer replaced while queued is written once.
+void
+ircd::net::dns::cache::writer()
+try
+{
+	// Wait for run::level RUN before entering work loop.
+	run::barrier<ctx::interrupted>{};
+	const ctx::uninterruptible ui; do
 	{
-		json::get<"state_key"_>(event)
+		writer_dock.wait([]
+		{
+			return !writes.empty() || ctx::termination(writer_context);
+		});
+
+		if(writes.empty() && ctx::termination(writer_context))
+			break;
+
+		auto batch
+		{
+			std::move(writes)
+		};
+
+		writes.clear();
+		for(const auto &[key, content] : batch)
+			write(key, content);
+	}
+	while(1);
+}
+catch(const std::exception &e)
+{
+	log::critical
+	{
+		log, "cache writer unhandled :%s",
+		e.what(),
 	};
+}
 
-	const json::array &rrs
+void
+ircd::net::dns::cache::write(const string_view &key,
+                             const string_view &content)
+try
+{
+	const auto &[type, state_key]
 	{
-		json::get<"content"_>(event).get("")
+		split(key, '\0')
 	};
 
-	waiter::call(rfc1035::qtype.at(lstrip(type, "ircd.dns.rrs.")), state_key, rrs);
+	const m::room room
+	{
+		dns_room_id
+	};
+
+	if(unlikely(!exists(room)))
+		create(room, m::me(), "internal");
+
+	send(room, m::me(), type, state_key, json::object{content});
+	++stats_writes;
 }
 catch(const std::exception &e)
 {
-	log::critical
+	log::error
 	{
-		log, "handle_cached() :%s", e.what()
+		log, "cache write (%s) :%s",
+		key,
+		e.what(),
 	};
 }
 
@@ -10,6 +10,7 @@
 
 namespace ircd::stats
 {
+	static void write_histogram(resource::response::chunked &, const string_view &name, const histogram &, const time_t &);
 	static resource::response get_stats(client &, const resource::request &);
 
 	extern resource::method method_get;
@@ -59,6 +60,18 @@ ircd::stats::get_stats(client &client,
 			replace(name[0], name_, '.', '_')
 		};
 
+		if(item->type == typeid(histogram *))
+		{
+			const auto &hist
+			{
+				dynamic_cast<const stats::item<histogram *> &>(*item)
+			};
+
+			assert(hist.val);
+			write_histogram(response, strlcpy(name[1], _name), *hist.val, ts);
+			continue;
+		}
+
 		const string_view line
 		{
 			buf,
@@ -76,3 +89,67 @@ ircd::stats::get_stats(client &client,
 
 	return std::move(response);
 }
+
+/// Prometheus histogram exposition: cumulative `le` buckets up to the highest
+/// non-empty bucket, then +Inf, _sum and _count. Bucket bounds are the
+/// inclusive upper bound of each log-linear bucket.
+void
+ircd::stats::write_histogram(resource::response::chunked &response,
+                             const string_view &name,
+                             const histogram &hist,
+                             const time_t &ts)
+{
+	char buf[256];
+	const auto write{[&response, &buf]
+	(const int &len)
+	{
+		response.write(string_view
+		{
+			buf, std::min(size_t(len), sizeof(buf) - 1)
+		});
+	}};
+
+	uint64_t cumulative(0);
+	const size_t last(hist.last());
+	for(size_t i(0); i <= last && hist.count; ++i)
+	{
+		// Skip empty buckets between populated ones to keep the output short;
+		// cumulative counts remain correct for any subset of bounds.
+		if(!hist.bucket[i] && i != last)
+			continue;
+
+		cumulative += hist.bucket[i];
+		write(::snprintf
+		(
+			buf, sizeof(buf), "%s_bucket{le=\"%lu\"} %lu %lu\n",
+			data(name),
+			histogram::upper(i),
+			cumulative,
+			ts
+		));
+	}
+
+	write(::snprintf
+	(
+		buf, sizeof(buf), "%s_bucket{le=\"+Inf\"} %lu %lu\n",
+		data(name),
+		hist.count,
+		ts
+	));
+
+	write(::snprintf
+	(
+		buf, sizeof(buf), "%s_sum %lu %lu\n",
+		data(name),
+		hist.sum,
+		ts
+	));
+
+	write(::snprintf
+	(
+		buf, sizeof(buf), "%s_count %lu %lu\n",
+		data(name),
+		hist.count,
+		ts
+	));
+}